@@ -0,0 +1,299 @@
+#include "batch.h"
+#include <pthread.h>
+#include <unistd.h> // For sysconf
+
+// ------------- Workload Setup -------------
+
+bool addWorkloadProgram(Workload *w, const char *spec)
+{
+  if (w->count >= MAX_PROCESSES)
+  {
+    fprintf(stderr, "Error: workload is limited to %d programs, ignoring '%s'\n", MAX_PROCESSES, spec);
+    return false;
+  }
+
+  WorkloadProgram *p = &w->programs[w->count];
+  const char *at = strrchr(spec, '@');
+  size_t pathLen = at ? (size_t)(at - spec) : strlen(spec);
+  if (pathLen == 0 || pathLen >= sizeof(p->path))
+  {
+    fprintf(stderr, "Error: invalid program spec '%s'\n", spec);
+    return false;
+  }
+  memcpy(p->path, spec, pathLen);
+  p->path[pathLen] = '\0';
+
+  p->arrivalTime = 0;
+  if (at)
+  {
+    char *endptr;
+    long arrival = strtol(at + 1, &endptr, 10);
+    if (*endptr != '\0' || arrival < 0)
+    {
+      fprintf(stderr, "Error: invalid arrival time in '%s'\n", spec);
+      return false;
+    }
+    p->arrivalTime = (int)arrival;
+  }
+  w->count++;
+  return true;
+}
+
+bool addWorkloadInput(Workload *w, const char *value)
+{
+  if (w->inputCount >= BATCH_MAX_INPUTS)
+  {
+    fprintf(stderr, "Error: at most %d input values are supported\n", BATCH_MAX_INPUTS);
+    return false;
+  }
+  w->inputs[w->inputCount++] = value;
+  return true;
+}
+
+void defaultSchedulerConfig(SchedulerConfig *cfg, SchedulerType type, int rrQuantum)
+{
+  memset(cfg, 0, sizeof(*cfg));
+  cfg->type = type;
+  cfg->rrQuantum = rrQuantum;
+  // Same defaults as initializeSystem
+  cfg->mlfqLevels = MLFQ_LEVELS;
+  for (int l = 0; l < MLFQ_LEVELS; l++)
+  {
+    cfg->mlfqQuantum[l] = 1 << l;
+  }
+}
+
+void formatSchedulerConfig(const SchedulerConfig *cfg, char *buf, size_t len)
+{
+  if (cfg->type == SIM_SCHED_FCFS)
+  {
+    snprintf(buf, len, "FCFS");
+  }
+  else if (cfg->type == SIM_SCHED_RR)
+  {
+    snprintf(buf, len, "RR q=%d", cfg->rrQuantum);
+  }
+  else
+  {
+    int off = snprintf(buf, len, "MLFQ levels=%d quanta=", cfg->mlfqLevels);
+    for (int l = 0; l < cfg->mlfqLevels && off > 0 && (size_t)off < len; l++)
+    {
+      off += snprintf(buf + off, len - off, l == 0 ? "%d" : ",%d", cfg->mlfqQuantum[l]);
+    }
+  }
+}
+
+// ------------- Single Run -------------
+
+// Input is supplied by the run loop after stepSimulation returns; the callback
+// only has to exist so that 'assign x input' waits for input instead of terminating.
+static void batch_request_input(void *gui_data, int pid, const char *varName)
+{
+  (void)gui_data;
+  (void)pid;
+  (void)varName;
+}
+
+static int compareInts(const void *a, const void *b)
+{
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+void runWorkload(const Workload *w, const SchedulerConfig *cfg, int maxCycles, RunResult *out)
+{
+  memset(out, 0, sizeof(*out));
+  out->failedProgram = -1;
+
+  // All other callbacks stay NULL, so logs and output are discarded without formatting
+  GuiCallbacks callbacks = {0};
+  callbacks.request_input = batch_request_input;
+
+  SystemState *sys = malloc(sizeof(SystemState));
+  if (!sys)
+  {
+    fprintf(stderr, "Error: out of host memory for a simulation run\n");
+    return;
+  }
+  initializeSystem(sys, cfg->type, cfg->rrQuantum, &callbacks, NULL);
+  if (cfg->type == SIM_SCHED_MLFQ)
+  {
+    setMLFQConfig(sys, cfg->mlfqLevels, cfg->mlfqQuantum);
+  }
+
+  // Data files come from the host, but writes stay private to this run
+  setFsHostDir(sys, ".", false);
+  if (w->uncached)
+    setFsCache(sys, 0, FS_CACHE_LRU, false);
+  setDiskModel(sys, w->diskSeek, w->diskTransfer);
+  setDiskPolicy(sys, w->diskPolicy);
+
+  // Scripts are shared by concurrent runs, so consume a private copy of the entries
+  InputScript script;
+  inputScriptInit(&script);
+  if (w->inputScript && w->inputScript->count > 0)
+  {
+    script.entries = malloc(w->inputScript->count * sizeof(InputScriptEntry));
+    if (!script.entries)
+    {
+      fprintf(stderr, "Error: out of host memory for a simulation run\n");
+      free(sys);
+      return;
+    }
+    memcpy(script.entries, w->inputScript->entries, w->inputScript->count * sizeof(InputScriptEntry));
+    script.count = script.capacity = w->inputScript->count;
+    inputScriptRewind(&script);
+    setInputScript(sys, &script);
+  }
+
+  for (int i = 0; i < w->count; i++)
+  {
+    if (!loadProgramAt(sys, w->programs[i].path, w->programs[i].arrivalTime))
+    {
+      out->failedProgram = i;
+      inputScriptFree(&script);
+      free(sys);
+      return;
+    }
+  }
+
+  int inputIndex = 0;
+  while (!isSimulationComplete(sys) && sys->clockCycle < maxCycles)
+  {
+    stepSimulation(sys);
+    if (sys->needsInput)
+    {
+      const char *value = w->inputCount > 0 ? w->inputs[inputIndex++ % w->inputCount] : "0";
+      provideInput(sys, value);
+    }
+  }
+
+  out->completed = isSimulationComplete(sys);
+  out->cycles = sys->clockCycle;
+  out->processCount = sys->processCount;
+
+  out->contextSwitches = sys->contextSwitches;
+  out->responseHistogram = sys->responseHistogram;
+  out->waitingHistogram = sys->waitingHistogram;
+  for (int r = 0; r < NUM_RESOURCES; r++)
+    latencyMerge(&out->lockWaitHistogram, &sys->mutexes[r].stats.wait);
+  out->diskRequests = sys->disk.requests;
+  out->avgSeek = sys->disk.requests > 0 ? (double)sys->disk.seekTracks / sys->disk.requests : 0;
+  out->diskWaitHistogram = sys->disk.latency;
+
+  int responses[MAX_PROCESSES];
+  long turnaroundSum = 0, responseSum = 0, waitingSum = 0, cpuSum = 0;
+  double rateSum = 0, rateSquareSum = 0;
+  for (int i = 0; i < sys->processCount; i++)
+  {
+    PCB *pcb = &sys->processTable[i];
+    int finish = pcb->completionTime >= 0 ? pcb->completionTime : sys->clockCycle;
+    int start = pcb->firstRunTime >= 0 ? pcb->firstRunTime : sys->clockCycle;
+    if (pcb->completionTime >= 0)
+      out->finishedCount++;
+    turnaroundSum += finish - pcb->arrivalTime;
+    responses[i] = start - pcb->arrivalTime;
+    responseSum += responses[i];
+    waitingSum += pcb->waitingTime;
+    cpuSum += pcb->cpuCycles;
+    double rate = finish > pcb->arrivalTime ? (double)pcb->cpuCycles / (finish - pcb->arrivalTime) : 0;
+    rateSum += rate;
+    rateSquareSum += rate * rate;
+  }
+
+  if (sys->processCount > 0)
+  {
+    out->avgTurnaround = (double)turnaroundSum / sys->processCount;
+    out->avgResponse = (double)responseSum / sys->processCount;
+    out->avgWaiting = (double)waitingSum / sys->processCount;
+    out->cpuUtilization = sys->clockCycle > 0 ? (double)cpuSum / sys->clockCycle : 0;
+    out->fairness = rateSquareSum > 0 ? rateSum * rateSum / (sys->processCount * rateSquareSum) : 1;
+    qsort(responses, sys->processCount, sizeof(int), compareInts);
+    int rank = (99 * sys->processCount + 99) / 100; // Nearest-rank percentile
+    out->p99Response = responses[rank - 1];
+  }
+  inputScriptFree(&script);
+  free(sys);
+}
+
+// ------------- Random Numbers -------------
+
+uint64_t batchRandom(uint64_t *state)
+{
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+int batchRandomRange(uint64_t *state, int bound)
+{
+  return bound > 0 ? (int)(batchRandom(state) % (uint64_t)bound) : 0;
+}
+
+double batchRandomUnit(uint64_t *state)
+{
+  return (batchRandom(state) >> 11) * (1.0 / 9007199254740992.0); // 53 random bits
+}
+
+// ------------- Thread Pool -------------
+
+typedef struct
+{
+  pthread_mutex_t lock;
+  int next;
+  int jobCount;
+  BatchJob job;
+  void *ctx;
+} JobQueue;
+
+static void *batch_worker(void *arg)
+{
+  JobQueue *q = (JobQueue *)arg;
+  for (;;)
+  {
+    pthread_mutex_lock(&q->lock);
+    int index = q->next < q->jobCount ? q->next++ : -1;
+    pthread_mutex_unlock(&q->lock);
+    if (index < 0)
+      break;
+    q->job(q->ctx, index);
+  }
+  return NULL;
+}
+
+int hostCoreCount(void)
+{
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (int)n : 1;
+}
+
+void runParallel(int jobCount, int threads, BatchJob job, void *ctx)
+{
+  if (threads <= 0)
+    threads = hostCoreCount();
+  if (threads > jobCount)
+    threads = jobCount;
+
+  JobQueue q = {.next = 0, .jobCount = jobCount, .job = job, .ctx = ctx};
+  pthread_mutex_init(&q.lock, NULL);
+
+  pthread_t *workers = threads > 1 ? malloc(sizeof(pthread_t) * threads) : NULL;
+  int started = 0;
+  if (workers)
+  {
+    for (; started < threads - 1; started++)
+    {
+      if (pthread_create(&workers[started], NULL, batch_worker, &q) != 0)
+        break;
+    }
+  }
+  // The calling thread always takes part, so a failed pthread_create only loses parallelism
+  batch_worker(&q);
+  for (int i = 0; i < started; i++)
+  {
+    pthread_join(workers[i], NULL);
+  }
+  free(workers);
+  pthread_mutex_destroy(&q.lock);
+}
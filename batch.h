@@ -0,0 +1,84 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// Headless batch execution: runs workloads on private SystemStates, optionally
+// spread over a pool of host threads. Used by the command-line tools, not the GUI.
+
+#include "simulator.h"
+#include <stdint.h>
+
+#define BATCH_MAX_INPUTS 32
+#define BATCH_PATH_LENGTH 256
+
+// One program of a workload and the clock cycle it arrives at
+typedef struct
+{
+    char path[BATCH_PATH_LENGTH];
+    int arrivalTime;
+} WorkloadProgram;
+
+// A set of programs plus the values fed to 'assign x input': from the script if it has one for
+// the request, else from inputs (used in order, wrapping around)
+typedef struct
+{
+    WorkloadProgram programs[MAX_PROCESSES];
+    int count;
+    const char *inputs[BATCH_MAX_INPUTS];
+    int inputCount;
+    const InputScript *inputScript; // NULL if none; each run consumes a private copy
+    // Disk behind the simulated filesystem (see setDiskModel); all zero leaves it instant
+    int diskSeek, diskTransfer;
+    DiskPolicy diskPolicy;
+    bool uncached; // No buffer cache, so every file instruction waits for the disk
+} Workload;
+
+// Scheduler parameters for a single run
+typedef struct
+{
+    SchedulerType type;
+    int rrQuantum;
+    int mlfqLevels;
+    int mlfqQuantum[MLFQ_LEVELS];
+} SchedulerConfig;
+
+// Outcome of a single run; times are in clock cycles
+typedef struct
+{
+    bool completed; // All processes terminated before the cycle limit
+    int failedProgram; // Index in Workload.programs of a program that failed to load (nothing ran), else -1
+    int cycles;
+    int processCount;
+    int finishedCount;
+    double avgTurnaround; // Unfinished processes count up to the cycle limit
+    double avgResponse;
+    int p99Response;
+    double avgWaiting;     // Cycles spent in ready queues
+    double cpuUtilization; // Fraction of cycles executing an instruction
+    int contextSwitches;
+    double fairness; // Jain's index over per-process progress rate (cpu cycles / turnaround)
+    // Distributions; merge them with latencyMerge to get percentiles across runs
+    LatencyHistogram responseHistogram;
+    LatencyHistogram waitingHistogram;
+    LatencyHistogram lockWaitHistogram;
+    long diskRequests;
+    double avgSeek; // Tracks per disk request
+    LatencyHistogram diskWaitHistogram; // Issue to completion, per disk request
+} RunResult;
+
+bool addWorkloadProgram(Workload *w, const char *spec); // spec is "file[@arrival]"
+bool addWorkloadInput(Workload *w, const char *value);
+void defaultSchedulerConfig(SchedulerConfig *cfg, SchedulerType type, int rrQuantum);
+void formatSchedulerConfig(const SchedulerConfig *cfg, char *buf, size_t len);
+void runWorkload(const Workload *w, const SchedulerConfig *cfg, int maxCycles, RunResult *out);
+
+// Small deterministic PRNG (splitmix64) so seeded runs reproduce on any host
+uint64_t batchRandom(uint64_t *state);
+int batchRandomRange(uint64_t *state, int bound); // Uniform in [0, bound)
+double batchRandomUnit(uint64_t *state);          // Uniform in [0, 1)
+
+// Runs job(ctx, 0..jobCount-1) on up to `threads` host threads (<= 0 means one per core)
+typedef void (*BatchJob)(void *ctx, int index);
+int hostCoreCount(void);
+void runParallel(int jobCount, int threads, BatchJob job, void *ctx);
+
+#endif // BATCH_H
@@ -0,0 +1,310 @@
+// bench.c
+// Engine throughput benchmark: simulated cycles per second and instructions per
+// second of stepSimulation for each scheduler, growing process counts and
+// several instruction mixes. Output is CSV (default) or JSON for regression tracking.
+
+#include "simulator.h"
+#include <time.h>
+#include <unistd.h> // For getopt, chdir, rmdir
+
+typedef enum
+{
+  MIX_COMPUTE,   // Plain assignments only
+  MIX_SEMAPHORE, // semWait/semSignal around every assignment
+  MIX_PRINT,     // print and printFromTo under userOutput
+  MIX_FILE,      // writeFile / readFile round trips under the file lock
+  MIX_COUNT
+} InstructionMix;
+
+static const char *mixNames[MIX_COUNT] = {"compute", "semaphore", "print", "file"};
+
+typedef enum
+{
+  LOG_NONE,   // No logger: events discarded unformatted
+  LOG_TEXT,   // No-op log_message: every event formatted
+  LOG_EVENTS  // Event log attached: typed records, never formatted
+} LogMode;
+
+static const char *logModeNames[] = {"none", "text", "events"};
+
+typedef struct
+{
+  const char *scheduler;
+  const char *mix;
+  int processes;
+  int programLines;
+  int runs;
+  unsigned long cycles;
+  unsigned long instructions;
+  double seconds;
+} BenchResult;
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  -f format   csv (default) or json\n"
+          "  -t seconds  minimum measured time per benchmark point (default 0.2)\n"
+          "  -m mix      only run one mix: compute, semaphore, print or file\n"
+          "  -l log      logging during the run: none (default), text or events\n",
+          prog);
+}
+
+static double nowSeconds(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// ------------- Workload Generation -------------
+
+// Writes one program of exactly `lines` instructions for the given mix.
+// Every program uses at most NUM_VARIABLES variables and always terminates.
+static bool writeMixProgram(const char *path, InstructionMix mix, int pid, int lines)
+{
+  FILE *f = fopen(path, "w");
+  if (!f)
+  {
+    fprintf(stderr, "Error: cannot write '%s': %s\n", path, strerror(errno));
+    return false;
+  }
+
+  int n = 0;
+  switch (mix)
+  {
+  case MIX_COMPUTE:
+    for (; n < lines; n++)
+      fprintf(f, "assign %c %d\n", 'a' + n % 2, n);
+    break;
+  case MIX_SEMAPHORE:
+  {
+    static const char *res[] = {"file", "userInput", "userOutput"};
+    for (; n + 3 <= lines; n += 3)
+      fprintf(f, "semWait %s\nassign a %d\nsemSignal %s\n", res[(n / 3) % 3], n, res[(n / 3) % 3]);
+    for (; n < lines; n++)
+      fprintf(f, "assign a %d\n", n);
+    break;
+  }
+  case MIX_PRINT:
+    fprintf(f, "assign a 1\nassign b 4\n");
+    for (n = 2; n + 4 <= lines; n += 4)
+      fprintf(f, "semWait userOutput\nprint a\nprintFromTo a b\nsemSignal userOutput\n");
+    for (; n < lines; n++)
+      fprintf(f, "print b\n");
+    break;
+  case MIX_FILE:
+    // Variables: f (file name), d (data) and file_f (created by readFile)
+    fprintf(f, "assign f bench_%d.tmp\nassign d payload%d\n", pid, pid);
+    for (n = 2; n + 4 <= lines; n += 4)
+      fprintf(f, "semWait file\nwriteFile f d\nassign d readFile f\nsemSignal file\n");
+    for (; n < lines; n++)
+      fprintf(f, "assign d %d\n", n);
+    break;
+  default:
+    break;
+  }
+  fclose(f);
+  return true;
+}
+
+// ------------- Measurement -------------
+
+static void discardLog(void *data, const char *message)
+{
+  (void)data;
+  (void)message;
+}
+
+static SchedulerType schedulerFromName(const char *name)
+{
+  return strcmp(name, "FCFS") == 0 ? SIM_SCHED_FCFS : strcmp(name, "RR") == 0 ? SIM_SCHED_RR
+                                                                              : SIM_SCHED_MLFQ;
+}
+
+// Repeats full simulations until minSeconds of stepSimulation time has accumulated.
+// Program loading is outside the timed region.
+static bool runPoint(const char *scheduler, InstructionMix mix, int processes, int lines, double minSeconds,
+                     LogMode logMode, BenchResult *out)
+{
+  memset(out, 0, sizeof(*out));
+  out->scheduler = scheduler;
+  out->mix = mixNames[mix];
+  out->processes = processes;
+  out->programLines = lines;
+
+  char paths[MAX_PROCESSES][32];
+  for (int i = 0; i < processes; i++)
+  {
+    snprintf(paths[i], sizeof(paths[i]), "bench_prog_%d.txt", i);
+    if (!writeMixProgram(paths[i], mix, i, lines))
+      return false;
+  }
+
+  GuiCallbacks callbacks = {0}; // No output: measure the engine (and the chosen logging) alone
+  if (logMode == LOG_TEXT)
+    callbacks.log_message = discardLog;
+  EventLog events;
+  eventLogInit(&events);
+  SystemState *sys = malloc(sizeof(SystemState));
+  if (!sys)
+    return false;
+
+  bool ok = true;
+  while (ok && (out->seconds < minSeconds || out->runs == 0))
+  {
+    initializeSystem(sys, schedulerFromName(scheduler), 2, &callbacks, NULL);
+    if (logMode == LOG_EVENTS)
+    {
+      eventLogClear(&events);
+      setEventLog(sys, &events);
+    }
+    for (int i = 0; i < processes && ok; i++)
+      ok = loadProgram(sys, paths[i]);
+    if (!ok)
+      break;
+
+    double start = nowSeconds();
+    while (!isSimulationComplete(sys))
+      stepSimulation(sys);
+    out->seconds += nowSeconds() - start;
+    out->cycles += sys->clockCycle;
+    out->instructions += sys->instructionsExecuted;
+    out->runs++;
+  }
+
+  free(sys);
+  eventLogFree(&events);
+  for (int i = 0; i < processes; i++)
+    remove(paths[i]);
+  return ok;
+}
+
+// ------------- Output -------------
+
+static void printResult(const BenchResult *r, bool json, bool first)
+{
+  double cps = r->seconds > 0 ? r->cycles / r->seconds : 0;
+  double ips = r->seconds > 0 ? r->instructions / r->seconds : 0;
+  if (json)
+  {
+    printf("%s  {\"scheduler\": \"%s\", \"mix\": \"%s\", \"processes\": %d, \"program_lines\": %d, "
+           "\"runs\": %d, \"cycles\": %lu, \"instructions\": %lu, \"seconds\": %.6f, "
+           "\"cycles_per_sec\": %.0f, \"instructions_per_sec\": %.0f}",
+           first ? "" : ",\n", r->scheduler, r->mix, r->processes, r->programLines, r->runs, r->cycles,
+           r->instructions, r->seconds, cps, ips);
+  }
+  else
+  {
+    printf("%s,%s,%d,%d,%d,%lu,%lu,%.6f,%.0f,%.0f\n", r->scheduler, r->mix, r->processes, r->programLines, r->runs,
+           r->cycles, r->instructions, r->seconds, cps, ips);
+  }
+  fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+  bool json = false;
+  double minSeconds = 0.2;
+  int onlyMix = -1;
+  LogMode logMode = LOG_NONE;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "f:t:m:l:h")) != -1)
+  {
+    switch (opt)
+    {
+    case 'f':
+      json = strcmp(optarg, "json") == 0;
+      break;
+    case 't':
+      minSeconds = atof(optarg);
+      break;
+    case 'm':
+      for (int m = 0; m < MIX_COUNT; m++)
+      {
+        if (strcmp(optarg, mixNames[m]) == 0)
+          onlyMix = m;
+      }
+      if (onlyMix < 0)
+      {
+        usage(argv[0]);
+        return 2;
+      }
+      break;
+    case 'l':
+      logMode = (LogMode)-1;
+      for (int l = 0; l <= LOG_EVENTS; l++)
+      {
+        if (strcmp(optarg, logModeNames[l]) == 0)
+          logMode = (LogMode)l;
+      }
+      if (logMode == (LogMode)-1)
+      {
+        usage(argv[0]);
+        return 2;
+      }
+      break;
+    default:
+      usage(argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+
+  // Generated programs and the files they write live in a private scratch directory
+  char scratch[] = "/tmp/minisimbench.XXXXXX";
+  char cwd[4096];
+  if (!getcwd(cwd, sizeof(cwd)) || !mkdtemp(scratch) || chdir(scratch) != 0)
+  {
+    fprintf(stderr, "Error: cannot set up scratch directory: %s\n", strerror(errno));
+    return 1;
+  }
+
+  static const char *schedulers[] = {"FCFS", "RR", "MLFQ"};
+  if (json)
+    printf("[\n");
+  else
+    printf("scheduler,mix,processes,program_lines,runs,cycles,instructions,seconds,cycles_per_sec,instructions_per_sec\n");
+
+  bool first = true;
+  int status = 0;
+  for (int s = 0; s < 3; s++)
+  {
+    for (int m = 0; m < MIX_COUNT; m++)
+    {
+      if (onlyMix >= 0 && m != onlyMix)
+        continue;
+      for (int n = 1; n <= MAX_PROCESSES; n *= 2)
+      {
+        // Largest program that still lets n processes fit in memory
+        int lines = MEMORY_SIZE / n - NUM_VARIABLES - PCB_SIZE;
+        if (lines > MAX_PROGRAM_LINES)
+          lines = MAX_PROGRAM_LINES;
+        if (lines < 6)
+          break;
+        BenchResult r;
+        if (!runPoint(schedulers[s], (InstructionMix)m, n, lines, minSeconds, logMode, &r))
+        {
+          fprintf(stderr, "Error: benchmark %s/%s/%d failed\n", schedulers[s], mixNames[m], n);
+          status = 1;
+          continue;
+        }
+        printResult(&r, json, first);
+        first = false;
+      }
+    }
+  }
+  if (json)
+    printf("\n]\n");
+
+  // Remove files written by the file-heavy mix
+  for (int i = 0; i < MAX_PROCESSES; i++)
+  {
+    char path[32];
+    snprintf(path, sizeof(path), "bench_%d.tmp", i);
+    remove(path);
+  }
+  if (chdir(cwd) != 0 || rmdir(scratch) != 0)
+    fprintf(stderr, "Warning: could not remove scratch directory %s\n", scratch);
+  return status;
+}
@@ -0,0 +1,441 @@
+// gen.c
+// Seeded synthetic workload generator: writes Program_N.txt files with a controlled
+// instruction mix and lock usage pattern, plus a trace listing every program with
+// an arrival time drawn from a Poisson, bursty or diurnal process. The same seed
+// and options always produce the same files.
+//
+// Trace format (trace.txt, sorted by arrival; paths relative to the trace):
+//   <arrival> Program_<N>.txt
+// With -B, processes are burst-model entries written inline and no program files:
+//   <arrival> burst cpu 4 file 2 cpu 7
+
+#include "batch.h"
+#include <math.h>
+#include <sys/stat.h> // For mkdir
+#include <unistd.h>   // For getopt
+
+typedef enum
+{
+  OP_ASSIGN, // assign a <literal>
+  OP_PRINT,  // print a
+  OP_RANGE,  // printFromTo a b
+  OP_INPUT,  // assign a input
+  OP_WRITE,  // writeFile f a
+  OP_READ,   // assign a readFile f
+  OP_COUNT
+} GenOp;
+
+static const char *opNames[OP_COUNT] = {"assign", "print", "range", "input", "write", "read"};
+static const int opResource[OP_COUNT] = {-1, RESOURCE_USER_OUTPUT, RESOURCE_USER_OUTPUT, RESOURCE_USER_INPUT,
+                                         RESOURCE_FILE, RESOURCE_FILE};
+static const char *resourceNames[NUM_RESOURCES] = {"file", "userInput", "userOutput"};
+
+typedef enum
+{
+  LOCKS_NONE,   // No semaphores at all
+  LOCKS_FINE,   // Each resource-using instruction wrapped in its own semWait/semSignal
+  LOCKS_COARSE  // Every resource the program uses held from start to end
+} LockPattern;
+
+typedef enum
+{
+  ARRIVAL_POISSON, // Exponential gaps, mean 1/rate
+  ARRIVAL_BURSTY,  // Groups of burstSize arrivals, exponential gaps between groups
+  ARRIVAL_DIURNAL  // Poisson with rate varying sinusoidally over a period
+} ArrivalModel;
+
+typedef struct
+{
+  int count;
+  uint64_t seed;
+  int minLines, maxLines;
+  int weights[OP_COUNT];
+  LockPattern locks;
+  ArrivalModel arrivals;
+  double rate;      // Poisson and diurnal mean arrivals per cycle
+  int burstSize;    // Bursty: arrivals per burst
+  double burstGap;  // Bursty: mean cycles between bursts
+  double period;    // Diurnal: cycles per day
+  double amplitude; // Diurnal: relative rate swing, 0..1
+  int maxPhases;    // Burst mode: phases per process (0 = write programs instead)
+} GenOptions;
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+          "Usage: %s [options] outdir\n"
+          "  -n count      number of programs (default 1000)\n"
+          "  -s seed       random seed (default 1)\n"
+          "  -L min-max    lines per program (default 4-%d), or cycles per phase with -B\n"
+          "  -m mix        instruction weights, e.g. assign=60,print=20,range=10,write=5,read=5,input=0\n"
+          "  -p locks      none, fine (default) or coarse\n"
+          "  -a arrivals   poisson:RATE (default poisson:0.2), bursty:SIZE:GAP\n"
+          "                or diurnal:RATE:PERIOD[:AMPLITUDE]\n"
+          "  -B phases     burst-model processes with up to this many phases, inline in\n"
+          "                the trace (fine locks alternate cpu and resource phases,\n"
+          "                coarse locks hold one resource throughout)\n",
+          prog, MAX_PROGRAM_LINES);
+}
+
+// ------------- Option Parsing -------------
+
+static bool parseMix(const char *s, int *weights)
+{
+  memset(weights, 0, sizeof(int) * OP_COUNT);
+  char buf[256];
+  snprintf(buf, sizeof(buf), "%s", s);
+  char *save;
+  int total = 0;
+  for (char *tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save))
+  {
+    char *eq = strchr(tok, '=');
+    if (!eq)
+      return false;
+    *eq = '\0';
+    int op = -1;
+    for (int i = 0; i < OP_COUNT; i++)
+    {
+      if (strcmp(tok, opNames[i]) == 0)
+        op = i;
+    }
+    int w = atoi(eq + 1);
+    if (op < 0 || w < 0)
+      return false;
+    weights[op] = w;
+    total += w;
+  }
+  return total > 0;
+}
+
+static bool parseArrivals(const char *s, GenOptions *o)
+{
+  if (sscanf(s, "poisson:%lf", &o->rate) == 1 && o->rate > 0)
+  {
+    o->arrivals = ARRIVAL_POISSON;
+    return true;
+  }
+  if (sscanf(s, "bursty:%d:%lf", &o->burstSize, &o->burstGap) == 2 && o->burstSize > 0 && o->burstGap >= 0)
+  {
+    o->arrivals = ARRIVAL_BURSTY;
+    return true;
+  }
+  int n = sscanf(s, "diurnal:%lf:%lf:%lf", &o->rate, &o->period, &o->amplitude);
+  if (n >= 2 && o->rate > 0 && o->period > 0 && o->amplitude >= 0 && o->amplitude <= 1)
+  {
+    o->arrivals = ARRIVAL_DIURNAL;
+    return true;
+  }
+  return false;
+}
+
+// ------------- Arrivals -------------
+
+static double exponentialGap(uint64_t *rng, double mean)
+{
+  return -log(1.0 - batchRandomUnit(rng)) * mean;
+}
+
+// Fills arrivals[0..count) in non-decreasing order
+static void generateArrivals(const GenOptions *o, uint64_t *rng, int *arrivals)
+{
+  double t = 0;
+  for (int i = 0; i < o->count; i++)
+  {
+    switch (o->arrivals)
+    {
+    case ARRIVAL_POISSON:
+      if (i > 0)
+        t += exponentialGap(rng, 1.0 / o->rate);
+      break;
+    case ARRIVAL_BURSTY:
+      if (i > 0 && i % o->burstSize == 0)
+        t += exponentialGap(rng, o->burstGap);
+      break;
+    case ARRIVAL_DIURNAL:
+    {
+      // Thinning: candidates at the peak rate, kept with probability rate(t) / peak
+      double peak = o->rate * (1 + o->amplitude);
+      if (i == 0)
+        break;
+      for (;;)
+      {
+        t += exponentialGap(rng, 1.0 / peak);
+        double rate = o->rate * (1 + o->amplitude * sin(2 * M_PI * t / o->period));
+        if (batchRandomUnit(rng) * peak < rate)
+          break;
+      }
+      break;
+    }
+    }
+    arrivals[i] = t < 2e9 ? (int)t : 2000000000;
+  }
+}
+
+// ------------- Programs -------------
+
+static GenOp pickOp(const GenOptions *o, uint64_t *rng, int totalWeight)
+{
+  int r = batchRandomRange(rng, totalWeight);
+  for (int op = 0; op < OP_COUNT; op++)
+  {
+    if (r < o->weights[op])
+      return (GenOp)op;
+    r -= o->weights[op];
+  }
+  return OP_ASSIGN;
+}
+
+static void writeOp(FILE *f, GenOp op, bool haveFile, uint64_t *rng)
+{
+  switch (op)
+  {
+  case OP_ASSIGN:
+    fprintf(f, "assign a %d\n", batchRandomRange(rng, 1000));
+    break;
+  case OP_PRINT:
+    fprintf(f, "print a\n");
+    break;
+  case OP_RANGE:
+    fprintf(f, haveFile ? "printFromTo a a\n" : "printFromTo a b\n");
+    break;
+  case OP_INPUT:
+    fprintf(f, "assign a input\n");
+    break;
+  case OP_WRITE:
+    fprintf(f, "writeFile f a\n");
+    break;
+  case OP_READ:
+    fprintf(f, "assign a readFile f\n");
+    break;
+  default:
+    break;
+  }
+}
+
+// Variables stay within NUM_VARIABLES: a and b, or a, f and file_f when files are used
+static bool writeProgram(const char *dir, int number, const GenOptions *o, uint64_t *rng)
+{
+  int totalWeight = 0;
+  for (int i = 0; i < OP_COUNT; i++)
+    totalWeight += o->weights[i];
+
+  int lines = o->minLines + batchRandomRange(rng, o->maxLines - o->minLines + 1);
+  int budget = lines - 2; // Two setup assignments
+  if (o->locks == LOCKS_COARSE)
+    budget -= 2 * NUM_RESOURCES; // Worst case: every resource taken and released
+
+  GenOp ops[MAX_PROGRAM_LINES];
+  int opCount = 0;
+  bool usesResource[NUM_RESOURCES] = {false};
+  bool haveFile = false;
+  while (budget > 0)
+  {
+    GenOp op = pickOp(o, rng, totalWeight);
+    if (op == OP_READ && !haveFile)
+      op = OP_WRITE; // The file must exist before it is read
+    int cost = 1 + (o->locks == LOCKS_FINE && opResource[op] >= 0 ? 2 : 0);
+    if (cost > budget)
+    {
+      op = OP_ASSIGN;
+      cost = 1;
+    }
+    if (opResource[op] >= 0)
+      usesResource[opResource[op]] = true;
+    haveFile = haveFile || op == OP_WRITE;
+    ops[opCount++] = op;
+    budget -= cost;
+  }
+
+  char path[BATCH_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s/Program_%d.txt", dir, number);
+  FILE *f = fopen(path, "w");
+  if (!f)
+  {
+    fprintf(stderr, "Error: cannot write '%s': %s\n", path, strerror(errno));
+    return false;
+  }
+
+  fprintf(f, "assign a %d\n", batchRandomRange(rng, 100));
+  if (haveFile)
+    fprintf(f, "assign f gen_%d.dat\n", number);
+  else
+    fprintf(f, "assign b %d\n", 100 + batchRandomRange(rng, 100));
+
+  if (o->locks == LOCKS_COARSE)
+  {
+    for (int r = 0; r < NUM_RESOURCES; r++)
+    {
+      if (usesResource[r])
+        fprintf(f, "semWait %s\n", resourceNames[r]);
+    }
+  }
+  for (int i = 0; i < opCount; i++)
+  {
+    int r = opResource[ops[i]];
+    if (o->locks == LOCKS_FINE && r >= 0)
+      fprintf(f, "semWait %s\n", resourceNames[r]);
+    writeOp(f, ops[i], haveFile, rng);
+    if (o->locks == LOCKS_FINE && r >= 0)
+      fprintf(f, "semSignal %s\n", resourceNames[r]);
+  }
+  if (o->locks == LOCKS_COARSE)
+  {
+    for (int r = NUM_RESOURCES - 1; r >= 0; r--)
+    {
+      if (usesResource[r])
+        fprintf(f, "semSignal %s\n", resourceNames[r]);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+// Appends " burst ..." phases for one burst-model process to the trace line
+static void writeBurstEntry(FILE *trace, const GenOptions *o, uint64_t *rng)
+{
+  int phases = 1 + batchRandomRange(rng, o->maxPhases);
+  int coarseResource = batchRandomRange(rng, NUM_RESOURCES);
+  fprintf(trace, " burst");
+  for (int i = 0; i < phases; i++)
+  {
+    int cycles = o->minLines + batchRandomRange(rng, o->maxLines - o->minLines + 1);
+    const char *name = "cpu";
+    if (o->locks == LOCKS_COARSE)
+      name = resourceNames[coarseResource];
+    else if (o->locks == LOCKS_FINE && i % 2 == 1)
+      name = resourceNames[batchRandomRange(rng, NUM_RESOURCES)];
+    fprintf(trace, " %s %d", name, cycles);
+  }
+}
+
+// ------------- Main -------------
+
+int main(int argc, char **argv)
+{
+  GenOptions o = {.count = 1000, .seed = 1, .minLines = 4, .maxLines = MAX_PROGRAM_LINES, .locks = LOCKS_FINE,
+                  .arrivals = ARRIVAL_POISSON, .rate = 0.2, .amplitude = 0.8};
+  const char *mixSpec = "assign=60,print=20,range=10,write=5,read=5";
+  const char *arrivalSpec = "poisson:0.2";
+  parseMix(mixSpec, o.weights);
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:s:L:m:p:a:B:h")) != -1)
+  {
+    switch (opt)
+    {
+    case 'n':
+      o.count = atoi(optarg);
+      break;
+    case 's':
+      o.seed = strtoull(optarg, NULL, 10);
+      break;
+    case 'L':
+      if (sscanf(optarg, "%d-%d", &o.minLines, &o.maxLines) != 2)
+        o.minLines = o.maxLines = atoi(optarg);
+      break;
+    case 'm':
+      if (!parseMix(optarg, o.weights))
+      {
+        fprintf(stderr, "Error: invalid instruction mix '%s'\n", optarg);
+        return 2;
+      }
+      mixSpec = optarg;
+      break;
+    case 'p':
+      if (strcmp(optarg, "none") == 0)
+        o.locks = LOCKS_NONE;
+      else if (strcmp(optarg, "fine") == 0)
+        o.locks = LOCKS_FINE;
+      else if (strcmp(optarg, "coarse") == 0)
+        o.locks = LOCKS_COARSE;
+      else
+      {
+        usage(argv[0]);
+        return 2;
+      }
+      break;
+    case 'a':
+      if (!parseArrivals(optarg, &o))
+      {
+        fprintf(stderr, "Error: invalid arrival model '%s'\n", optarg);
+        return 2;
+      }
+      arrivalSpec = optarg;
+      break;
+    case 'B':
+      o.maxPhases = atoi(optarg);
+      if (o.maxPhases < 1 || o.maxPhases > MAX_BURSTS)
+      {
+        fprintf(stderr, "Error: burst processes have 1 to %d phases\n", MAX_BURSTS);
+        return 2;
+      }
+      break;
+    default:
+      usage(argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+  int minLines = o.maxPhases > 0 ? 1 : o.locks == LOCKS_COARSE ? 3 + 2 * NUM_RESOURCES : 3;
+  int maxLines = o.maxPhases > 0 ? 1000000 : MAX_PROGRAM_LINES;
+  if (optind != argc - 1 || o.count < 1 || o.minLines < minLines || o.maxLines < o.minLines || o.maxLines > maxLines)
+  {
+    if (optind == argc - 1)
+      fprintf(stderr, "Error: need count >= 1 and %d <= min <= max <= %d\n", minLines, maxLines);
+    usage(argv[0]);
+    return 2;
+  }
+  const char *dir = argv[optind];
+  if (mkdir(dir, 0755) != 0 && errno != EEXIST)
+  {
+    fprintf(stderr, "Error: cannot create '%s': %s\n", dir, strerror(errno));
+    return 1;
+  }
+
+  // Separate streams so changing the arrival model keeps the same programs
+  uint64_t programRng = o.seed;
+  uint64_t arrivalRng = o.seed ^ 0x5DEECE66DULL;
+  int *arrivals = malloc(sizeof(int) * o.count);
+  if (!arrivals)
+    return 1;
+  generateArrivals(&o, &arrivalRng, arrivals);
+
+  char tracePath[BATCH_PATH_LENGTH];
+  snprintf(tracePath, sizeof(tracePath), "%s/trace.txt", dir);
+  FILE *trace = fopen(tracePath, "w");
+  if (!trace)
+  {
+    fprintf(stderr, "Error: cannot write '%s': %s\n", tracePath, strerror(errno));
+    free(arrivals);
+    return 1;
+  }
+  fprintf(trace, "# minisimgen -n %d -s %llu -L %d-%d -m %s -p %s -a %s", o.count,
+          (unsigned long long)o.seed, o.minLines, o.maxLines, mixSpec,
+          o.locks == LOCKS_NONE ? "none" : o.locks == LOCKS_FINE ? "fine" : "coarse", arrivalSpec);
+  if (o.maxPhases > 0) // Program files are the default; -B 0 would not be accepted back
+    fprintf(trace, " -B %d", o.maxPhases);
+  fputc('\n', trace);
+
+  int status = 0;
+  for (int i = 0; i < o.count; i++)
+  {
+    if (o.maxPhases > 0)
+    {
+      fprintf(trace, "%d", arrivals[i]);
+      writeBurstEntry(trace, &o, &programRng);
+      fprintf(trace, "\n");
+      continue;
+    }
+    if (!writeProgram(dir, i + 1, &o, &programRng))
+    {
+      status = 1;
+      break;
+    }
+    fprintf(trace, "%d Program_%d.txt\n", arrivals[i], i + 1);
+  }
+  fclose(trace);
+  if (status == 0)
+    fprintf(stderr, "Wrote %d %s and %s (last arrival at cycle %d)\n", o.count,
+            o.maxPhases > 0 ? "burst processes" : "programs", tracePath, arrivals[o.count - 1]);
+  free(arrivals);
+  return status;
+}
@@ -17,6 +17,8 @@ typedef struct
   GtkWidget *reset_button;
   GtkDropDown *scheduler_dropdown;
   GtkStringList *scheduler_model;
+  GtkDropDown *log_level_dropdown; // Log detail for every engine category
+  GtkStringList *log_level_model; // Owned by the dropdown
   GtkWidget *rr_quantum_entry;
   GtkWidget *load_p1_button;
   GtkWidget *load_p2_button;
@@ -37,6 +39,9 @@ typedef struct
 
   SystemState sim_state;  // Holds the entire simulator state
   GuiCallbacks callbacks; // Callbacks passed to the simulator
+  EventLog event_log;     // Engine events not yet shown in the log view
+  InputScript input_script; // From -I; answers input requests before the prompt appears
+  GQueue *typeahead;        // Values submitted before they were asked for (g_strdup'd), oldest first
 
   guint run_timer_id; // Timer ID for continuous run
   bool is_running;    // Flag if simulation is auto-running
@@ -49,9 +54,9 @@ typedef struct
 
 // --- Forward Declarations ---
 static void gui_log_message(void *gui_data, const char *format, ...);
-static void gui_log_message_wrapper(void *gui_data, const char *message);
+static void flush_event_log(GuiApp *gui_app);
 static void gui_process_output(void *gui_data, int pid, const char *output);
-static gboolean gui_request_input_internal(GuiApp *gui_app, int process_id, const char *var_name, gboolean numeric);
+static void sync_input_prompt(GuiApp *gui_app);
 static void gui_request_input(void *gui_data, int pid, const char *varName);
 static void gui_state_update(void *gui_data, SystemState *sys G_GNUC_UNUSED);
 static void update_ui_from_state(GuiApp *gui_app);
@@ -61,12 +66,16 @@ static void on_reset_button_clicked(GtkButton *button G_GNUC_UNUSED, gpointer us
 static void on_load_program_clicked(GtkButton *button, gpointer user_data);
 static gboolean run_simulation_step(gpointer user_data);
 static void stop_continuous_run(GuiApp *gui_app);
+static void resume_continuous_run(GuiApp *gui_app);
 static void on_scheduler_changed(GtkDropDown *dropdown G_GNUC_UNUSED, GParamSpec *pspec G_GNUC_UNUSED, gpointer user_data);
+static void apply_log_level(GuiApp *gui_app);
+static void on_log_level_changed(GtkDropDown *dropdown G_GNUC_UNUSED, GParamSpec *pspec G_GNUC_UNUSED, gpointer user_data);
 static void on_submit_input_button_clicked(GtkButton *button, gpointer user_data);
 static gboolean flash_input_area(GtkWidget *frame);
 static gboolean unflash_input_area(GtkWidget *frame);
 static void gui_add_status_message(GuiApp *gui_app, const char *message);
 static void on_quick_input_button_clicked(GtkButton *button, gpointer user_data);
+static void feed_typeahead(GuiApp *gui_app);
 static char *format_process_list_and_queues(SystemState *sys);
 
 // Macro for logging - defined after forward declarations
@@ -83,18 +92,42 @@ static void gui_add_status_message(GuiApp *gui_app, const char *message)
 
 // --- Callback Implementations ---
 
-// Simple wrapper for the simulator callback interface
-static void gui_log_message_wrapper(void *gui_data, const char *message)
+// Appends one line to the log text view and scrolls to it
+static void append_log_line(GuiApp *gui_app, const char *line)
 {
-  // Just pass the message directly, no formatting
-  gui_log_message(gui_data, "%s", message);
+  GtkTextIter end;
+  gtk_text_buffer_get_end_iter(gui_app->log_buffer, &end);
+  gtk_text_buffer_insert(gui_app->log_buffer, &end, line, -1);
+  gtk_text_buffer_insert(gui_app->log_buffer, &end, "\n", -1);
+
+  // Auto-scroll
+  GtkAdjustment *vadj = gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(gui_app->log_view));
+  if (vadj)
+  {
+    gtk_adjustment_set_value(vadj, gtk_adjustment_get_upper(vadj) - gtk_adjustment_get_page_size(vadj));
+  }
+}
+
+// Formats the engine events recorded since the last flush into the log view.
+// The engine never formats log text itself; this is the only place it happens.
+static void flush_event_log(GuiApp *gui_app)
+{
+  char line[256];
+  for (size_t i = 0; i < gui_app->event_log.count; i++)
+  {
+    formatSimEvent(&gui_app->event_log, &gui_app->event_log.events[i], line, sizeof(line));
+    append_log_line(gui_app, line);
+  }
+  eventLogClear(&gui_app->event_log);
 }
 
 // Appends a message to the log text view with printf-style formatting
 static void gui_log_message(void *gui_data, const char *format, ...)
 {
   GuiApp *gui_app = (GuiApp *)gui_data;
-  GtkTextIter end;
+
+  // Engine events recorded so far come first, keeping the log in order
+  flush_event_log(gui_app);
 
   // Format the message
   char buffer[1024];
@@ -103,17 +136,7 @@ static void gui_log_message(void *gui_data, const char *format, ...)
   vsnprintf(buffer, sizeof(buffer), format, args);
   va_end(args);
 
-  // Append to text buffer
-  gtk_text_buffer_get_end_iter(gui_app->log_buffer, &end);
-  gtk_text_buffer_insert(gui_app->log_buffer, &end, buffer, -1);
-  gtk_text_buffer_insert(gui_app->log_buffer, &end, "\n", -1);
-
-  // Auto-scroll
-  GtkAdjustment *vadj = gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(gui_app->log_view));
-  if (vadj)
-  {
-    gtk_adjustment_set_value(vadj, gtk_adjustment_get_upper(vadj) - gtk_adjustment_get_page_size(vadj));
-  }
+  append_log_line(gui_app, buffer);
 }
 
 // Appends process-specific output to its text view
@@ -136,34 +159,49 @@ static void gui_process_output(void *gui_data, int pid, const char *output)
 }
 
 // Wrapper function for the simulator callback
-static void gui_request_input(void *gui_data, int pid, const char *varName)
+static void gui_request_input(void *gui_data, int pid G_GNUC_UNUSED, const char *varName G_GNUC_UNUSED)
 {
-  GuiApp *gui_app = (GuiApp *)gui_data;
-  // Assume non-numeric by default (can be adjusted based on variable name if needed)
-  gui_request_input_internal(gui_app, pid, varName, FALSE);
+  // The engine has already queued the request; the prompt always shows the oldest one
+  sync_input_prompt((GuiApp *)gui_data);
 }
 
-// Shows the embedded input prompt area (internal implementation)
-static gboolean gui_request_input_internal(GuiApp *gui_app, int process_id, const char *var_name, gboolean numeric)
+// Shows the embedded input prompt for the request provideInput answers next (sys->inputPid and
+// inputVarName) and keeps it up while sys->needsInput holds; hides it otherwise
+static void sync_input_prompt(GuiApp *gui_app)
 {
-  // Add LOG message for debugging
-  LOG("GUI: Input requested for process %d, variable %s (numeric: %s)",
-      process_id, var_name, numeric ? "yes" : "no");
+  SystemState *sys = &gui_app->sim_state;
+  GtkWidget *input_frame = gtk_widget_get_parent(gui_app->input_prompt_box);
+
+  // A queued value answers the request as soon as the step returns (see feed_typeahead)
+  if (!sys->needsInput || !g_queue_is_empty(gui_app->typeahead))
+  {
+    gtk_widget_set_visible(input_frame, FALSE);
+    gui_app->input_process_id = -1;
+    return;
+  }
+  if (gtk_widget_get_visible(input_frame) && gui_app->input_process_id == sys->inputPid && gui_app->input_var_name &&
+      strcmp(gui_app->input_var_name, sys->inputVarName) == 0)
+    return; // Already showing this request
+
+  PCB *pcb = findPCB(sys, sys->inputPid);
+  int program = pcb ? pcb->programNumber : sys->inputPid;
+  LOG("GUI: Input requested for P%d, variable %s (numeric: %s)", program, sys->inputVarName,
+      gui_app->input_numeric ? "yes" : "no");
 
   // Set input state
-  gui_app->input_process_id = process_id;
-  gui_app->input_var_name = g_strdup(var_name);
-  gui_app->input_numeric = numeric;
+  gui_app->input_process_id = sys->inputPid;
+  g_free(gui_app->input_var_name);
+  gui_app->input_var_name = g_strdup(sys->inputVarName);
 
   // Update prompt with specific message
   char *prompt_message;
-  if (numeric)
+  if (gui_app->input_numeric)
   {
-    prompt_message = g_strdup_printf("<b>Enter a NUMBER for process %d, variable %s:</b>", process_id, var_name);
+    prompt_message = g_strdup_printf("<b>Enter a NUMBER for process %d, variable %s:</b>", program, sys->inputVarName);
   }
   else
   {
-    prompt_message = g_strdup_printf("<b>Enter a STRING for process %d, variable %s:</b>", process_id, var_name);
+    prompt_message = g_strdup_printf("<b>Enter a STRING for process %d, variable %s:</b>", program, sys->inputVarName);
   }
   gtk_label_set_markup(GTK_LABEL(gui_app->input_prompt_label), prompt_message);
   g_free(prompt_message);
@@ -175,16 +213,7 @@ static gboolean gui_request_input_internal(GuiApp *gui_app, int process_id, cons
   gtk_editable_set_text(GTK_EDITABLE(gui_app->quick_input_entry), "");
   gtk_widget_grab_focus(gui_app->quick_input_entry);
 
-  // If auto-running, stop the timer
-  if (gui_app->is_running && gui_app->run_timer_id > 0)
-  {
-    g_source_remove(gui_app->run_timer_id);
-    gui_app->run_timer_id = 0;
-    // Note: we keep is_running=true so we can resume after input
-  }
-
   // Make the input prompt visible and grab focus to the entry
-  GtkWidget *input_frame = gtk_widget_get_parent(gui_app->input_prompt_box);
   gtk_widget_set_visible(input_frame, TRUE);
 
   // Flash the input area a couple of times to draw attention
@@ -196,8 +225,6 @@ static gboolean gui_request_input_internal(GuiApp *gui_app, int process_id, cons
 
   // Add status message
   gui_add_status_message(gui_app, "Input required! Please check the input box above.");
-
-  return TRUE;
 }
 
 // Helper functions for flashing the input area
@@ -221,18 +248,19 @@ static void on_submit_input_button_clicked(GtkButton *button G_GNUC_UNUSED, gpoi
   // Get text from entry
   const char *input_text = gtk_editable_get_text(GTK_EDITABLE(gui_app->input_entry));
 
-  // Pass input to simulator (simulator handles NULL if needed)
+  // Pass input to simulator (simulator handles NULL if needed); it answers the oldest request,
+  // the one the prompt shows
+  if (!gui_app->sim_state.needsInput)
+    return;
+  gui_log_message(gui_app, "Input provided: %s", input_text);
   provideInput(&gui_app->sim_state, input_text);
 
-  // Clear entry and hide input area
+  // Clear entry
   gtk_editable_set_text(GTK_EDITABLE(gui_app->input_entry), "");
 
-  // Hide the input frame, not just the box
-  GtkWidget *input_frame = gtk_widget_get_parent(gui_app->input_prompt_box);
-  gtk_widget_set_visible(input_frame, FALSE);
-
-  // Update UI (re-enables controls, updates status)
+  // Update UI (re-enables controls, updates status, moves the prompt to the next request or hides it)
   update_ui_from_state(gui_app);
+  resume_continuous_run(gui_app);
 }
 
 // Called by the simulator when state changes significantly
@@ -250,16 +278,20 @@ static void gui_state_update(void *gui_data, SystemState *sys G_GNUC_UNUSED)
 static void update_ui_from_state(GuiApp *gui_app)
 {
   SystemState *sys = &gui_app->sim_state;
+  flush_event_log(gui_app);
   char status_text[200];
   const char *running_status = "Idle";
   bool is_waiting_for_input = sys->needsInput;
+  sync_input_prompt(gui_app); // The prompt follows the oldest pending request
 
   // --- Determine Control Sensitivity ---
   bool sim_complete = isSimulationComplete(sys);
   // Only allow step/run if there is at least one process loaded
   bool has_processes = sys->processCount > 0;
-  bool can_step = !sim_complete && !gui_app->is_running && !is_waiting_for_input && has_processes;
-  bool can_run = !sim_complete && !gui_app->is_running && !is_waiting_for_input && has_processes;
+  // A pending input only blocks the process that asked, so Step keeps going; a continuous run
+  // waits for the answer (see run_simulation_step)
+  bool can_step = !sim_complete && !gui_app->is_running && has_processes;
+  bool can_run = !sim_complete && !gui_app->is_running && has_processes;
   bool can_reset = !gui_app->is_running && !is_waiting_for_input;
   bool can_load = !gui_app->is_running && !is_waiting_for_input && (sys->processCount < MAX_PROCESSES);
   bool can_change_sched = !gui_app->is_running && !is_waiting_for_input && sys->processCount == 0;
@@ -339,7 +371,17 @@ static void update_ui_from_state(GuiApp *gui_app)
       GtkWidget *label = gtk_widget_get_first_child(parent_box);
       if (GTK_IS_LABEL(label))
       {
-        gtk_label_set_text(GTK_LABEL(label), "Input Value:");
+        guint queued = g_queue_get_length(gui_app->typeahead);
+        if (queued > 0)
+        {
+          char label_text[64];
+          snprintf(label_text, sizeof(label_text), "Input Value (%u queued):", queued);
+          gtk_label_set_text(GTK_LABEL(label), label_text);
+        }
+        else
+        {
+          gtk_label_set_text(GTK_LABEL(label), "Input Value:");
+        }
       }
     }
   }
@@ -354,8 +396,8 @@ static void update_ui_from_state(GuiApp *gui_app)
   gtk_widget_set_sensitive(gui_app->load_p3_button, can_load);
   gtk_widget_set_sensitive(GTK_WIDGET(gui_app->scheduler_dropdown), can_change_sched);
 
-  // Highlight the quick input when input is required
-  gtk_widget_set_sensitive(gui_app->quick_input_button, is_waiting_for_input);
+  // Highlight the quick input when input is required; before that, submitted values are queued
+  gtk_widget_set_sensitive(gui_app->quick_input_button, !sim_complete);
   if (is_waiting_for_input)
   {
     gtk_widget_add_css_class(gui_app->quick_input_entry, "input-flash");
@@ -368,8 +410,6 @@ static void update_ui_from_state(GuiApp *gui_app)
   guint selected_scheduler_index = gtk_drop_down_get_selected(gui_app->scheduler_dropdown);
   gtk_widget_set_sensitive(gui_app->rr_quantum_entry, can_change_sched && (selected_scheduler_index == 1));
 
-  // Input widgets sensitivity is handled by visibility in gui_request_input / on_submit_input
-
   // --- Update Process List and Queue Views ---
   char *process_info = format_process_list_and_queues(sys);
   gtk_label_set_text(GTK_LABEL(gui_app->process_list_view), process_info);
@@ -380,9 +420,10 @@ static void update_ui_from_state(GuiApp *gui_app)
 static void on_step_button_clicked(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
 {
   GuiApp *gui_app = (GuiApp *)user_data;
-  if (!gui_app->is_running && !isSimulationComplete(&gui_app->sim_state) && !gui_app->sim_state.needsInput)
+  if (!gui_app->is_running && !isSimulationComplete(&gui_app->sim_state))
   {
     stepSimulation(&gui_app->sim_state);
+    feed_typeahead(gui_app);
     // state update is triggered via callback
   }
 }
@@ -399,7 +440,7 @@ static void on_run_button_clicked(GtkButton *button G_GNUC_UNUSED, gpointer user
   else
   {
     // Start running
-    if (!isSimulationComplete(&gui_app->sim_state) && !gui_app->sim_state.needsInput)
+    if (!isSimulationComplete(&gui_app->sim_state))
     {
       gui_app->is_running = true;
       update_ui_from_state(gui_app); // Update button label to Pause
@@ -421,6 +462,14 @@ static void stop_continuous_run(GuiApp *gui_app)
     }
     gui_app->is_running = false;
     update_ui_from_state(gui_app); // Update button label and sensitivity
+    if (hostProfileEnabled())
+    {
+      // Shows whether the engine or these callbacks dominated the timed run so far
+      char profile[2048];
+      formatHostProfile(&gui_app->sim_state, profile, sizeof(profile));
+      flush_event_log(gui_app);
+      append_log_line(gui_app, profile);
+    }
   }
 }
 
@@ -432,19 +481,33 @@ static gboolean run_simulation_step(gpointer user_data)
   if (!gui_app->is_running)
     return G_SOURCE_REMOVE; // Stop if paused externally
 
-  if (isSimulationComplete(&gui_app->sim_state) || gui_app->sim_state.needsInput)
+  if (isSimulationComplete(&gui_app->sim_state))
   {
-    // Stop running if complete or needs input
+    // Stop running if complete
     stop_continuous_run(gui_app);
     return G_SOURCE_REMOVE; // Remove the timer
   }
 
   stepSimulation(&gui_app->sim_state);
+  feed_typeahead(gui_app); // Queued values answer right away, so the run never waits on them
   // gui_state_update callback handles UI refresh
 
+  if (gui_app->sim_state.needsInput)
+  {
+    // Nothing queued for the request: wait for the user, staying in run mode (see resume_continuous_run)
+    gui_app->run_timer_id = 0;
+    return G_SOURCE_REMOVE;
+  }
   return G_SOURCE_CONTINUE; // Keep timer running
 }
 
+// Restarts the timer of a continuous run that stopped to wait for input, once nothing is pending
+static void resume_continuous_run(GuiApp *gui_app)
+{
+  if (gui_app->is_running && gui_app->run_timer_id == 0 && !gui_app->sim_state.needsInput)
+    gui_app->run_timer_id = g_timeout_add(100, run_simulation_step, gui_app);
+}
+
 static void on_reset_button_clicked(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
 {
   GuiApp *gui_app = (GuiApp *)user_data;
@@ -468,6 +531,16 @@ static void on_reset_button_clicked(GtkButton *button G_GNUC_UNUSED, gpointer us
 
   // Re-initialize the simulator state
   initializeSystem(&gui_app->sim_state, type, rr_quantum, &gui_app->callbacks, gui_app);
+  eventLogClear(&gui_app->event_log);
+  setEventLog(&gui_app->sim_state, &gui_app->event_log);
+  setFsHostDir(&gui_app->sim_state, ".", true); // Files appear in the working directory on completion
+  g_queue_clear_full(gui_app->typeahead, g_free); // Typed for the previous run
+  if (gui_app->input_script.count > 0)
+  {
+    inputScriptRewind(&gui_app->input_script); // Each reset replays the script from the start
+    setInputScript(&gui_app->sim_state, &gui_app->input_script);
+  }
+  apply_log_level(gui_app);
 
   // Clear log views
   gtk_text_buffer_set_text(gui_app->log_buffer, "", -1);
@@ -523,6 +596,20 @@ static void on_scheduler_changed(GtkDropDown *dropdown G_GNUC_UNUSED, GParamSpec
   update_ui_from_state(gui_app); // Update sensitivity of quantum entry
 }
 
+// Applies the log detail dropdown to all engine log categories; takes effect from the next step
+static void apply_log_level(GuiApp *gui_app)
+{
+  static const SimLogLevel levels[] = {SIM_LOG_DEBUG, SIM_LOG_INFO, SIM_LOG_WARN, SIM_LOG_ERROR};
+  guint selected = gtk_drop_down_get_selected(gui_app->log_level_dropdown);
+  if (selected < G_N_ELEMENTS(levels))
+    setLogLevel(&gui_app->sim_state, SIM_LOG_ALL, levels[selected]);
+}
+
+static void on_log_level_changed(GtkDropDown *dropdown G_GNUC_UNUSED, GParamSpec *pspec G_GNUC_UNUSED, gpointer user_data)
+{
+  apply_log_level((GuiApp *)user_data);
+}
+
 // Handler for the Quick Input button
 static void on_quick_input_button_clicked(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
 {
@@ -531,38 +618,38 @@ static void on_quick_input_button_clicked(GtkButton *button G_GNUC_UNUSED, gpoin
   // Get text from entry
   const char *input_text = gtk_editable_get_text(GTK_EDITABLE(gui_app->quick_input_entry));
 
-  // Only provide input if the simulation is waiting for input
+  // Values go to the back of the typeahead queue; a pending request takes the oldest one
+  g_queue_push_tail(gui_app->typeahead, g_strdup(input_text));
   if (gui_app->sim_state.needsInput)
   {
-    // Pass input to simulator
-    provideInput(&gui_app->sim_state, input_text);
+    feed_typeahead(gui_app); // Also resumes a continuous run that was waiting for this
 
-    // Log the input action
-    gui_log_message(gui_app, "Input provided: %s", input_text);
-
-    // If auto-running was interrupted by input request, resume it
-    if (gui_app->is_running && gui_app->run_timer_id == 0)
-    {
-      gui_app->run_timer_id = g_timeout_add(100, run_simulation_step, gui_app);
-    }
-
-    // Update UI
+    // Update UI, including the prompt
     update_ui_from_state(gui_app);
-
-    // Hide the input frame since we've provided input
-    GtkWidget *input_frame = gtk_widget_get_parent(gui_app->input_prompt_box);
-    gtk_widget_set_visible(input_frame, FALSE);
   }
   else
   {
-    // Inform the user that input is not currently needed
-    gui_log_message(gui_app, "Input not required at this time");
+    gui_log_message(gui_app, "Input queued: %s (%u waiting)", input_text, g_queue_get_length(gui_app->typeahead));
+    update_ui_from_state(gui_app);
   }
 
   // Clear the quick input field
   gtk_editable_set_text(GTK_EDITABLE(gui_app->quick_input_entry), "");
 }
 
+// Answers pending input requests from the typeahead queue, oldest value first
+static void feed_typeahead(GuiApp *gui_app)
+{
+  while (gui_app->sim_state.needsInput && !g_queue_is_empty(gui_app->typeahead))
+  {
+    char *value = g_queue_pop_head(gui_app->typeahead);
+    gui_log_message(gui_app, "Input provided: %s", value);
+    provideInput(&gui_app->sim_state, value);
+    g_free(value);
+  }
+  resume_continuous_run(gui_app);
+}
+
 // Add this function before update_ui_from_state
 static char *format_process_list_and_queues(SystemState *sys)
 {
@@ -633,7 +720,7 @@ static char *format_process_list_and_queues(SystemState *sys)
                          "Time in CPU: %d cycles\n",
                          pcb->programNumber,
                          current_inst,
-                         sys->clockCycle - pcb->arrivalTime);
+                         pcb->cpuCycles);
     }
   }
 
@@ -777,6 +864,13 @@ static void activate(GtkApplication *app, gpointer user_data)
   gtk_box_append(GTK_BOX(control_hbox), gui_app->load_p2_button);
   gtk_box_append(GTK_BOX(control_hbox), gui_app->load_p3_button);
 
+  // Log detail; "All" includes every clock cycle and instruction, which floods the log at full speed
+  const char *log_levels[] = {"Log: All", "Log: Info", "Log: Warnings", "Log: Errors", NULL};
+  gui_app->log_level_model = gtk_string_list_new(log_levels);
+  gui_app->log_level_dropdown = GTK_DROP_DOWN(gtk_drop_down_new(G_LIST_MODEL(gui_app->log_level_model), NULL));
+  gtk_drop_down_set_selected(gui_app->log_level_dropdown, 0);
+  g_signal_connect(gui_app->log_level_dropdown, "notify::selected", G_CALLBACK(on_log_level_changed), gui_app);
+
   // Simulation Control Buttons
   gui_app->step_button = gtk_button_new_with_label("Step");
   gui_app->run_button = gtk_button_new_with_label("Run");
@@ -789,6 +883,8 @@ static void activate(GtkApplication *app, gpointer user_data)
   gtk_box_append(GTK_BOX(control_hbox), gui_app->step_button);
   gtk_box_append(GTK_BOX(control_hbox), gui_app->run_button);
   gtk_box_append(GTK_BOX(control_hbox), gui_app->reset_button);
+  gtk_box_append(GTK_BOX(control_hbox), gtk_separator_new(GTK_ORIENTATION_VERTICAL));
+  gtk_box_append(GTK_BOX(control_hbox), GTK_WIDGET(gui_app->log_level_dropdown));
 
   // --- Quick Input Box ---
   GtkWidget *quick_input_hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
@@ -944,12 +1040,32 @@ int main(int argc, char **argv)
   gui_app.is_running = false;
   gui_app.run_timer_id = 0;
 
-  // Setup simulator callbacks
-  gui_app.callbacks.log_message = gui_log_message_wrapper;
+  // Setup simulator callbacks; log messages are recorded in event_log instead of log_message
+  eventLogInit(&gui_app.event_log);
   gui_app.callbacks.process_output = gui_process_output;
   gui_app.callbacks.request_input = gui_request_input;
   gui_app.callbacks.state_update = gui_state_update;
 
+  gui_app.typeahead = g_queue_new();
+
+  // "-I script" is ours; GApplication gets the remaining arguments
+  inputScriptInit(&gui_app.input_script);
+  if (argc >= 3 && strcmp(argv[1], "-I") == 0)
+  {
+    int bad = inputScriptLoad(&gui_app.input_script, argv[2]);
+    if (bad != 0)
+    {
+      if (bad < 0)
+        fprintf(stderr, "Error: cannot open input script '%s'\n", argv[2]);
+      else
+        fprintf(stderr, "Error: %s:%d: expected '<program|*> <variable|*> <value>'\n", argv[2], bad);
+      return 2;
+    }
+    argv[2] = argv[0];
+    argv += 2;
+    argc -= 2;
+  }
+
   // Create GTK application
   gui_app.app = gtk_application_new("com.example.minisimulator", G_APPLICATION_DEFAULT_FLAGS);
   g_signal_connect(gui_app.app, "activate", G_CALLBACK(activate), &gui_app);
@@ -963,6 +1079,10 @@ int main(int argc, char **argv)
   {
     g_object_unref(gui_app.scheduler_model); // Free the string list model
   }
+  eventLogFree(&gui_app.event_log);
+  inputScriptFree(&gui_app.input_script);
+  g_queue_free_full(gui_app.typeahead, g_free);
+  g_free(gui_app.input_var_name);
 
   return status;
 }
\ No newline at end of file
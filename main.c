@@ -1,961 +1,559 @@
 // main.c
-// A mini-OS simulator supporting FCFS, Round‐Robin, and Multilevel Feedback Queue (MLFQ)
+// Headless command-line driver for the mini-OS simulator (simulator.c).
+// Supports FCFS, Round-Robin and Multilevel Feedback Queue (MLFQ) scheduling.
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <stdbool.h>
-#include <errno.h>
+#include "batch.h"
+#include <strings.h> // For strcasecmp
+#include <unistd.h>  // For getopt, isatty
 
-#define MEMORY_SIZE 60
-#define MAX_PROGRAM_LINES 50
-#define MAX_LINE_LENGTH 100
-#define NUM_VARIABLES 3
-#define PCB_SIZE 5 // for storing PCB fields in memory (optional)
-#define MAX_PROCESSES 10
-#define MAX_QUEUE_SIZE 10
-#define MLFQ_LEVELS 4
-#define NUM_RESOURCES 3 // file, userInput, userOutput
-
-// Scheduling policies
-typedef enum
-{
-  SCHED_FCFS,
-  SCHED_RR,
-  SCHED_MLFQ
-} SchedulerType;
-
-// Process states
 typedef enum
 {
-  NEW,
-  READY,
-  RUNNING,
-  BLOCKED,
-  TERMINATED
-} ProcessState;
-
-// Resources for semaphores
-typedef enum
-{
-  RESOURCE_FILE,
-  RESOURCE_USER_INPUT,
-  RESOURCE_USER_OUTPUT
-} ResourceType;
-
-// A memory word can hold a name and a value
-typedef struct
-{
-  char name[50];
-  char value[50];
-} MemoryWord;
+  OUTPUT_QUIET,   // Nothing but errors; exit status reports completion
+  OUTPUT_SUMMARY, // Program output plus a per-process table at the end
+  OUTPUT_TRACE    // Every simulator event as it happens, then the summary
+} OutputMode;
 
-// Process Control Block
 typedef struct
 {
-  int processID;
-  ProcessState state;
-  int priority; // used for resource-unblocking (lower=more urgent)
-  int programCounter;
-  int memoryLowerBound;
-  int memoryUpperBound;
-  int arrivalTime;
-  ResourceType blockedOnResource;
-  int quantumRemaining; // time‐slice left (RR & MLFQ)
-  int mlfqLevel;        // current level (0 highest … MLFQ_LEVELS-1 lowest)
-} PCB;
+  OutputMode mode;
+  const Workload *workload;
+  int nextInput;
+  const SystemState *sys; // Maps the pid of a callback to its program number
+} CliState;
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+          "Usage: %s [options] [program[@arrival]...]\n"
+          "  -s sched    fcfs (default), rr or mlfq\n"
+          "  -q quantum  RR quantum (default 2)\n"
+          "  -Q list     MLFQ quanta per level, e.g. 1,2,4,8 (also sets the level count)\n"
+          "  -o mode     quiet, summary (default) or trace\n"
+          "  -L levels   trace log levels, e.g. info or sched=debug,interp=off (see below)\n"
+          "  -T file     write a Chrome/Perfetto timeline of process states and locks to file;\n"
+          "              raises sched, interp, memory and sync to at least info\n"
+          "  -l          print lock contention statistics and the lines where processes blocked\n"
+          "  -p          print a hot-spot profile of the programs: cycles run, blocked and input\n"
+          "              stalls per line, busiest first\n"
+          "  -P          print host wall time per engine phase and opcode (needs make HOST_PROFILE=1)\n"
+          "  -i value    value for 'assign x input' (repeatable, used in order);\n"
+          "              once exhausted, values are read line by line from stdin\n"
+          "  -I script   answer 'assign x input' from a file of '<program|*> <variable|*> <value>'\n"
+          "              lines first; requests it has no value for fall back to -i and stdin\n"
+          "  -F dir      host directory behind the simulated filesystem (default .): files are\n"
+          "              imported on first read and changed ones written back at the end;\n"
+          "              'none' keeps all files in memory\n"
+          "  -C cache    file buffer cache: buffers[,lru|clock][,exitflush], e.g. 8,clock\n"
+          "              (default 16,lru; 0 disables); exitflush writes dirty blocks back\n"
+          "              whenever a process terminates instead of only at the end (through\n"
+          "              the disk, with -D; the final flush is free)\n"
+          "  -D disk     disk timing seek,transfer[,policy]: cycles per track crossed and per\n"
+          "              block (default 0,0: instant); file instructions that miss the cache\n"
+          "              or write blocks back block their process until the disk serves them;\n"
+          "              policy orders the queue: fcfs (default), sstf, scan, cscan or clook\n"
+          "  -c cycles   stop after this many cycles (default: run to completion)\n"
+          "  -w trace    stream the programs listed in a trace written by minisimgen;\n"
+          "              each is loaded when it arrives, reusing terminated processes' memory\n"
+          "Log categories: sched, interp, memory, sync, io, all; levels: off, error, warn, info, debug (default).\n"
+          "Without programs, Program_1.txt, Program_2.txt and Program_3.txt arrive at 0, 1 and 2.\n",
+          prog);
+}
 
-// Mutex with a FIFO + priority‐based blocked queue
-typedef struct
-{
-  bool locked;
-  int lockingProcessID;
-  int blockedQueue[MAX_QUEUE_SIZE];
-  int head, tail, size;
-} Mutex;
+// ------------- Simulator Callbacks -------------
 
-// Overall system state
-typedef struct
+static void cli_log_message(void *data, const char *message)
 {
-  MemoryWord memory[MEMORY_SIZE];
-  int memoryPointer;
-
-  PCB processTable[MAX_PROCESSES];
-  int processCount;
-
-  Mutex mutexes[NUM_RESOURCES];
-
-  // FCFS/RR ready queue
-  int readyQueue[MAX_QUEUE_SIZE];
-  int readyHead, readyTail, readySize;
-
-  // MLFQ ready queues per level
-  int mlfqRQ[MLFQ_LEVELS][MAX_QUEUE_SIZE];
-  int mlfqHead[MLFQ_LEVELS], mlfqTail[MLFQ_LEVELS], mlfqSize[MLFQ_LEVELS];
-
-  int runningProcessID;
-  int clockCycle;
-} SystemState;
-
-// Global
-SystemState osSystem;
-SchedulerType schedulerType;
-int rrQuantum;
-int mlfqQuantum[MLFQ_LEVELS] = {1, 2, 4, 8};
-
-// Function prototypes
-void initializeSystem(SystemState *sys);
-int allocateMemory(SystemState *sys, int words);
-void loadProgram(SystemState *sys, const char *filename, int arrivalTime);
-void runSimulation(SystemState *sys);
-PCB *findPCB(SystemState *sys, int pid);
-int findInstructionCount(SystemState *sys, int pid);
-
-void checkArrivals(SystemState *sys);
-void addToReadyQueue(SystemState *sys, int pid);
-int scheduleFCFS(SystemState *sys);
-
-void addToMLFQ(SystemState *sys, int pid, int level);
-int scheduleMLFQ(SystemState *sys);
-
-void interpretInstruction(SystemState *sys, int pid);
-
-int findVariableMemoryIndex(SystemState *sys, int pid, const char *var, bool findFree);
-void setVariable(SystemState *sys, int pid, const char *var, const char *value);
-char *getVariable(SystemState *sys, int pid, const char *var);
-
-void do_print(SystemState *sys, int pid, char *arg1);
-void do_assign(SystemState *sys, int pid, char *varName, char *valueOrInput);
-void do_writeFile(SystemState *sys, int pid, char *fileVar, char *dataVar);
-void do_readFile(SystemState *sys, int pid, char *fileVar);
-void do_printFromTo(SystemState *sys, int pid, char *v1, char *v2);
-void do_semWait(SystemState *sys, int pid, char *resName);
-void do_semSignal(SystemState *sys, int pid, char *resName);
-
-ResourceType getResourceTypeFromString(const char *s);
-bool enqueueMutexBlocked(Mutex *m, int pid);
-int dequeueMutexBlocked(Mutex *m);
-void blockProcess(SystemState *sys, int pid, ResourceType r);
-void unblockProcess(SystemState *sys, ResourceType r);
-
-// ---------------- Implementation ----------------
+  (void)data;
+  puts(message);
+}
 
-void initializeSystem(SystemState *sys)
+static void cli_process_output(void *data, int pid, const char *output)
 {
-  sys->memoryPointer = 0;
-  sys->processCount = 0;
-  sys->runningProcessID = -1;
-  sys->clockCycle = 0;
-  // Clear memory
-  for (int i = 0; i < MEMORY_SIZE; i++)
-  {
-    sys->memory[i].name[0] = 0;
-    sys->memory[i].value[0] = 0;
-  }
-  // Ready queue
-  sys->readyHead = sys->readyTail = sys->readySize = 0;
-  // MLFQ queues
-  for (int l = 0; l < MLFQ_LEVELS; l++)
-  {
-    sys->mlfqHead[l] = sys->mlfqTail[l] = sys->mlfqSize[l] = 0;
-  }
-  // Mutexes
-  for (int i = 0; i < NUM_RESOURCES; i++)
-  {
-    sys->mutexes[i].locked = false;
-    sys->mutexes[i].lockingProcessID = -1;
-    sys->mutexes[i].head = sys->mutexes[i].tail = sys->mutexes[i].size = 0;
-  }
+  const CliState *cli = (const CliState *)data;
+  printf("P%d OUTPUT: %s\n", cli->sys->processTable[pid].programNumber, output);
 }
 
-int allocateMemory(SystemState *sys, int words)
+// Input is handed over after stepSimulation returns (see nextInputValue)
+static void cli_request_input(void *data, int pid, const char *varName)
 {
-  if (sys->memoryPointer + words > MEMORY_SIZE)
-  {
-    printf("Error: Out of memory! Requested %d words, available %d.\n",
-           words, MEMORY_SIZE - sys->memoryPointer);
-    return -1;
-  }
-  int start = sys->memoryPointer;
-  sys->memoryPointer += words;
-  return start;
+  (void)data;
+  (void)pid;
+  (void)varName;
 }
 
-void loadProgram(SystemState *sys, const char *filename, int arrivalTime)
+// Returns the next scripted value, or reads one line from stdin
+static const char *nextInputValue(CliState *cli, SystemState *sys, char *buf, size_t len)
 {
-  if (sys->processCount >= MAX_PROCESSES)
-  {
-    printf("Error: process table full, cannot load %s\n", filename);
-    return;
-  }
-  FILE *f = fopen(filename, "r");
-  if (!f)
-  {
-    perror("fopen");
-    return;
-  }
-
-  // count non-empty lines
-  char buf[MAX_LINE_LENGTH];
-  int count = 0;
-  while (fgets(buf, sizeof(buf), f))
-  {
-    if (strspn(buf, " \t\r\n") < strlen(buf))
-      count++;
-  }
-  if (count == 0)
+  if (cli->nextInput < cli->workload->inputCount)
   {
-    printf("Warning: %s is empty.\n", filename);
-    fclose(f);
-    return;
+    return cli->workload->inputs[cli->nextInput++];
   }
-  if (count > MAX_PROGRAM_LINES)
+  if (isatty(STDIN_FILENO))
   {
-    printf("Warning: %s truncated to %d lines.\n", filename, MAX_PROGRAM_LINES);
-    count = MAX_PROGRAM_LINES;
+    PCB *pcb = findPCB(sys, sys->inputPid);
+    fprintf(stderr, "Input for P%d, variable %s: ", pcb ? pcb->programNumber : sys->inputPid, sys->inputVarName);
   }
-  rewind(f);
-
-  int memNeeded = count + NUM_VARIABLES + PCB_SIZE;
-  int lb = allocateMemory(sys, memNeeded);
-  if (lb < 0)
+  if (!fgets(buf, len, stdin))
   {
-    fclose(f);
-    return;
+    return NULL; // provideInput treats NULL as an empty string
   }
-  int ub = lb + memNeeded - 1;
-
-  PCB *pcb = &sys->processTable[sys->processCount];
-  pcb->processID = sys->processCount;
-  pcb->state = NEW;
-  pcb->priority = 0;
-  pcb->programCounter = 0;
-  pcb->memoryLowerBound = lb;
-  pcb->memoryUpperBound = ub;
-  pcb->arrivalTime = arrivalTime;
-  pcb->blockedOnResource = RESOURCE_FILE; // dummy
-  pcb->quantumRemaining = 0;
-  pcb->mlfqLevel = 0;
-
-  // load instructions
-  int idx = lb, line = 0;
-  while (line < count && fgets(buf, sizeof(buf), f))
-  {
-    if (strspn(buf, " \t\r\n") == strlen(buf))
-      continue;
-    buf[strcspn(buf, "\r\n")] = 0;
-    snprintf(sys->memory[idx].name, 50, "Inst_%d_%d", pcb->processID, line);
-    strncpy(sys->memory[idx].value, buf, 50);
-    idx++;
-    line++;
-  }
-  fclose(f);
-
-  // init variable slots
-  int varStart = lb + count;
-  for (int i = 0; i < NUM_VARIABLES && varStart + i <= ub; i++)
-  {
-    snprintf(sys->memory[varStart + i].name, 50, "Var_%d_Free%d", pcb->processID, i);
-    sys->memory[varStart + i].value[0] = 0;
-  }
-
-  printf("Loaded P%d: lines=%d, mem=[%d..%d], arrival=%d\n",
-         pcb->processID, count, lb, ub, arrivalTime);
-  sys->processCount++;
+  buf[strcspn(buf, "\r\n")] = 0;
+  return buf;
 }
 
-PCB *findPCB(SystemState *sys, int pid)
-{
-  if (pid < 0 || pid >= sys->processCount)
-    return NULL;
-  return &sys->processTable[pid];
-}
+// ------------- Reporting -------------
 
-int findInstructionCount(SystemState *sys, int pid)
+static const char *stateName(ProcessState s)
 {
-  PCB *pcb = findPCB(sys, pid);
-  if (!pcb)
-    return 0;
-  int cnt = 0;
-  for (int i = pcb->memoryLowerBound; i <= pcb->memoryUpperBound; i++)
+  switch (s)
   {
-    char prefix[20];
-    snprintf(prefix, sizeof(prefix), "Inst_%d_", pid);
-    if (strncmp(sys->memory[i].name, prefix, strlen(prefix)) == 0)
-      cnt++;
-    else
-      break;
+  case NEW:
+    return "NEW";
+  case READY:
+    return "READY";
+  case RUNNING:
+    return "RUNNING";
+  case BLOCKED:
+    return "BLOCKED";
+  case TERMINATED:
+    return "TERMINATED";
   }
-  return cnt;
+  return "UNKNOWN";
 }
 
-// ------------ Scheduling ------------
+static const char *const diskPolicyNames[] = {"fcfs", "sstf", "scan", "cscan", "clook"}; // DiskPolicy order
 
-void addToReadyQueue(SystemState *sys, int pid)
+static void printPercentiles(const char *name, const LatencyHistogram *h)
 {
-  if (sys->readySize >= MAX_QUEUE_SIZE)
-  {
-    printf("Error: Ready queue full, dropping P%d\n", pid);
-    return;
-  }
-  PCB *pcb = findPCB(sys, pid);
-  pcb->state = READY;
-  sys->readyQueue[sys->readyTail] = pid;
-  sys->readyTail = (sys->readyTail + 1) % MAX_QUEUE_SIZE;
-  sys->readySize++;
+  printf("%-11s %8ld %7d %7d %7d %7d %7d\n", name, h->count, latencyPercentile(h, 50), latencyPercentile(h, 90),
+         latencyPercentile(h, 99), latencyPercentile(h, 99.9), h->max);
 }
 
-int scheduleFCFS(SystemState *sys)
+static void printSummary(SystemState *sys)
 {
-  if (sys->readySize == 0)
-    return -1;
-  int pid = sys->readyQueue[sys->readyHead];
-  sys->readyHead = (sys->readyHead + 1) % MAX_QUEUE_SIZE;
-  sys->readySize--;
-  return pid;
-}
-
-void addToMLFQ(SystemState *sys, int pid, int level)
-{
-  if (level < 0 || level >= MLFQ_LEVELS)
-    return;
-  if (sys->mlfqSize[level] >= MAX_QUEUE_SIZE)
-  {
-    printf("Error: MLFQ level %d full, dropping P%d\n", level, pid);
-    return;
-  }
-  PCB *pcb = findPCB(sys, pid);
-  pcb->state = READY;
-  pcb->mlfqLevel = level;
-  pcb->priority = level;
-  sys->mlfqRQ[level][sys->mlfqTail[level]] = pid;
-  sys->mlfqTail[level] = (sys->mlfqTail[level] + 1) % MAX_QUEUE_SIZE;
-  sys->mlfqSize[level]++;
-}
-
-int scheduleMLFQ(SystemState *sys)
-{
-  for (int lvl = 0; lvl < MLFQ_LEVELS; lvl++)
-  {
-    if (sys->mlfqSize[lvl] > 0)
-    {
-      int pid = sys->mlfqRQ[lvl][sys->mlfqHead[lvl]];
-      sys->mlfqHead[lvl] = (sys->mlfqHead[lvl] + 1) % MAX_QUEUE_SIZE;
-      sys->mlfqSize[lvl]--;
-      return pid;
-    }
-  }
-  return -1;
-}
-
-// ------------- Interpreter -------------
-
-void interpretInstruction(SystemState *sys, int pid)
-{
-  PCB *pcb = findPCB(sys, pid);
-  if (!pcb || pcb->state != RUNNING)
-  {
-    printf("Error: P%d not runnable\n", pid);
-    return;
-  }
-  int instCount = findInstructionCount(sys, pid);
-  if (pcb->programCounter >= instCount)
-  {
-    // terminate
-    pcb->state = TERMINATED;
-    printf("P%d done\n", pid);
-    return;
-  }
-  int memIdx = pcb->memoryLowerBound + pcb->programCounter;
-  char line[MAX_LINE_LENGTH];
-  strncpy(line, sys->memory[memIdx].value, MAX_LINE_LENGTH);
-  printf("P%d executing [%s]\n", pid, line);
-
-  // tokenize
-  char *cmd = strtok(line, " ");
-  char *a1 = strtok(NULL, " ");
-  char *a2 = strtok(NULL, " ");
-  char *a3 = strtok(NULL, " ");
-
-  bool error = false;
-  if (!cmd)
-  { /*NOP*/
-  }
-  else if (strcmp(cmd, "print") == 0)
-  {
-    if (a1)
-      do_print(sys, pid, a1);
-    else
-      error = true;
-  }
-  else if (strcmp(cmd, "assign") == 0)
-  {
-    if (!a1 || !a2)
-    {
-      printf("Error in P%d: assign needs at least 2 args\n", pid);
-      findPCB(sys, pid)->state = TERMINATED;
-    }
-    else if (strcmp(a2, "input") == 0)
-    {
-      // interactive input
-      do_assign(sys, pid, a1, a2);
-    }
-    else if (strcmp(a2, "readFile") == 0)
-    {
-      // assign b readFile a  → do_readFile(a), then b = file_a
-      if (!a3)
-      {
-        printf("Error in P%d: assign readFile missing source var\n", pid);
-        findPCB(sys, pid)->state = TERMINATED;
-      }
-      else
-      {
-        // perform the read under the existing file‐mutex
-        do_readFile(sys, pid, a3);
-        // build the auto‐generated var name "file_<a3>"
-        char tmp[64];
-        snprintf(tmp, sizeof(tmp), "file_%s", a3);
-        char *cnt = getVariable(sys, pid, tmp);
-        if (cnt)
-        {
-          setVariable(sys, pid, a1, cnt);
-        }
-        else
-        {
-          printf("Error in P%d: readFile did not create %s\n",
-                 pid, tmp);
-          findPCB(sys, pid)->state = TERMINATED;
-        }
-      }
-    }
-    else
-    {
-      // literal assignment
-      setVariable(sys, pid, a1, a2);
-    }
-  }
-  else if (strcmp(cmd, "writeFile") == 0)
-  {
-    if (a1 && a2)
-      do_writeFile(sys, pid, a1, a2);
-    else
-      error = true;
-  }
-  else if (strcmp(cmd, "readFile") == 0)
+  printf("\nSimulation %s after %d cycles\n", isSimulationComplete(sys) ? "complete" : "stopped", sys->clockCycle);
+  printf("%-4s %-8s %-11s %8s %9s %10s %11s %9s %8s %6s %8s %9s %8s\n", "PID", "Program", "State", "Arrival",
+         "FirstRun", "Completion", "Turnaround", "Response", "Waiting", "CPU", "Blocked", "Switches", "Preempt");
+  for (int i = 0; i < sys->processCount; i++)
   {
-    if (a1)
-      do_readFile(sys, pid, a1);
+    ProcessMetrics m;
+    if (!getProcessMetrics(sys, i, &m))
+      continue; // Slot vacated for a streamed process; counted in sys->retired
+    printf("%-4d P%-7d %-11s %8d", i, m.programNumber, stateName(m.state), m.arrivalTime);
+    if (m.firstRunTime >= 0)
+      printf(" %9d", m.firstRunTime);
     else
-      error = true;
-  }
-  else if (strcmp(cmd, "printFromTo") == 0)
-  {
-    if (a1 && a2)
-      do_printFromTo(sys, pid, a1, a2);
+      printf(" %9s", "-");
+    if (m.completionTime >= 0)
+      printf(" %10d %11d", m.completionTime, m.turnaroundTime);
     else
-      error = true;
-  }
-  else if (strcmp(cmd, "semWait") == 0)
-  {
-    if (a1)
-      do_semWait(sys, pid, a1);
+      printf(" %10s %11s", "-", "-");
+    if (m.responseTime >= 0)
+      printf(" %9d", m.responseTime);
     else
-      error = true;
+      printf(" %9s", "-");
+    printf(" %8d %6d %8d %9d %8d\n", m.waitingTime, m.cpuCycles, m.blockedTotal, m.contextSwitches, m.preemptions);
   }
-  else if (strcmp(cmd, "semSignal") == 0)
+  if (sys->retired.count > 0)
   {
-    if (a1)
-      do_semSignal(sys, pid, a1);
-    else
-      error = true;
+    const ProcessTotals *r = &sys->retired;
+    printf("%d earlier processes retired: avg turnaround %.2f, avg response %.2f, avg waiting %.2f, avg blocked %.2f, "
+           "%ld switches, %ld preemptions\n",
+           r->count, (double)r->turnaround / r->count, (double)r->response / r->count, (double)r->waiting / r->count,
+           (double)r->blocked / r->count, r->contextSwitches, r->preemptions);
   }
-  else
+  if (sys->trace.admitted + sys->trace.skipped > 0)
   {
-    printf("Unknown cmd '%s' in P%d\n", cmd, pid);
-    error = true;
+    printf("Trace: %d processes admitted, %d skipped\n", sys->trace.admitted, sys->trace.skipped);
   }
-  if (error)
-  {
-    printf("Error in P%d, terminating.\n", pid);
-    pcb->state = TERMINATED;
-  }
-}
 
-// -------- Variable Management --------
+  LatencyHistogram lockWait = {0};
+  for (int r = 0; r < NUM_RESOURCES; r++)
+    latencyMerge(&lockWait, &sys->mutexes[r].stats.wait);
+  printf("\n%-11s %8s %7s %7s %7s %7s %7s\n", "Latency", "Samples", "p50", "p90", "p99", "p99.9", "Max");
+  printPercentiles("Response", &sys->responseHistogram);
+  printPercentiles("Waiting", &sys->waitingHistogram);
+  printPercentiles("Lock wait", &lockWait);
+  const SimDisk *d = &sys->disk;
+  if (d->requests > 0)
+    printPercentiles("Disk wait", &d->latency);
 
-int findVariableMemoryIndex(SystemState *sys, int pid, const char *var, bool findFree)
-{
-  PCB *pcb = findPCB(sys, pid);
-  if (!pcb)
-    return -1;
-  int instCnt = findInstructionCount(sys, pid);
-  int start = pcb->memoryLowerBound + instCnt;
-  int end = pcb->memoryUpperBound - PCB_SIZE;
-  char full[50];
-  snprintf(full, sizeof(full), "Var_%d_%s", pid, var);
-  int firstFree = -1;
-  for (int i = start; i <= end; i++)
+  const FsCacheStats *fc = &sys->fs.cacheStats;
+  long accesses = fc->reads + fc->writes;
+  if (accesses > 0)
   {
-    if (strcmp(sys->memory[i].name, full) == 0)
-      return i;
-    if (findFree)
-    {
-      char prefix[20];
-      snprintf(prefix, sizeof(prefix), "Var_%d_Free", pid);
-      if ((sys->memory[i].name[0] == 0 ||
-           strncmp(sys->memory[i].name, prefix, strlen(prefix)) == 0) &&
-          firstFree < 0)
-        firstFree = i;
-    }
+    printf("\nFile cache: %d buffers (%s), %ld block reads, %ld writes, hit rate %.1f%%, %ld writes coalesced, "
+           "%ld evictions, %ld flushes; store: %ld reads, %ld writes\n",
+           sys->fs.cacheSize, sys->fs.cachePolicy == FS_CACHE_CLOCK ? "clock" : "lru", fc->reads, fc->writes,
+           100.0 * fc->hits / accesses, fc->coalesced, fc->evictions, fc->flushes, fc->diskReads, fc->diskWrites);
   }
-  return findFree ? firstFree : -1;
-}
-
-void setVariable(SystemState *sys, int pid, const char *var, const char *value)
-{
-  int idx = findVariableMemoryIndex(sys, pid, var, true);
-  PCB *pcb = findPCB(sys, pid);
-  if (idx < 0)
+  if (d->requests > 0)
   {
-    printf("Var store error in P%d\n", pid);
-    pcb->state = TERMINATED;
-    return;
+    int cycles = sys->clockCycle > 0 ? sys->clockCycle : 1;
+    printf("Disk (%s): %ld requests, %ld blocks, %.2f requests per 100 cycles, %.1f%% busy, avg seek %.2f tracks\n",
+           diskPolicyNames[d->policy], d->requests, d->blocks, 100.0 * d->latency.count / cycles,
+           100.0 * d->busyCycles / cycles, (double)d->seekTracks / d->requests);
   }
-  snprintf(sys->memory[idx].name, 50, "Var_%d_%s", pid, var);
-  strncpy(sys->memory[idx].value, value, 50);
 }
 
-char *getVariable(SystemState *sys, int pid, const char *var)
-{
-  int idx = findVariableMemoryIndex(sys, pid, var, false);
-  PCB *pcb = findPCB(sys, pid);
-  if (idx < 0)
-  {
-    printf("Var lookup error '%s' in P%d\n", var, pid);
-    pcb->state = TERMINATED;
-    return NULL;
+static void printLockReport(SystemState *sys)
+{
+  static const char *resourceNames[NUM_RESOURCES] = {"file", "userInput", "userOutput"};
+  int cycles = sys->clockCycle > 0 ? sys->clockCycle : 1;
+  printf("\nLock contention (cycles)\n");
+  printf("%-11s %8s %9s %8s %7s %8s %7s %9s %8s\n", "Resource", "Acquired", "Contended", "AvgHold", "MaxHold",
+         "AvgWait", "MaxWait", "AvgQueue", "MaxQueue");
+  for (int r = 0; r < NUM_RESOURCES; r++)
+  {
+    const LockStats *st = &sys->mutexes[r].stats;
+    long holds = st->acquisitions - (sys->mutexes[r].locked ? 1 : 0); // The current hold is still open
+    printf("%-11s %8ld %9ld %8.2f %7d %8.2f %7d %9.2f %8d\n", resourceNames[r], st->acquisitions, st->contended,
+           holds > 0 ? (double)st->holdTotal / holds : 0.0, st->holdMax,
+           st->wait.count > 0 ? (double)st->wait.sum / st->wait.count : 0.0, st->wait.max,
+           (double)st->queueSum / cycles, st->queueMax);
+  }
+  printf("%-11s %8s %7s %7s %7s %7s %7s\n", "Lock wait", "Samples", "p50", "p90", "p99", "p99.9", "Max");
+  for (int r = 0; r < NUM_RESOURCES; r++)
+    printPercentiles(resourceNames[r], &sys->mutexes[r].stats.wait);
+
+  BlockSite sites[5];
+  int n = getTopBlockSites(sys, sites, 5);
+  if (n > 0)
+  {
+    printf("Top blocking lines\n");
+    for (int i = 0; i < n; i++)
+      printf("  P%d line %d on %s: %ld\n", sites[i].programNumber, sites[i].line + 1, resourceNames[sites[i].resource],
+             sites[i].count);
+    if (sys->blockSitesDropped > 0)
+      printf("  (%ld blocks at further lines not tracked)\n", sys->blockSitesDropped);
   }
-  return sys->memory[idx].value;
-}
-
-// -------- Instruction Handlers --------
-
-void do_print(SystemState *sys, int pid, char *arg1)
-{
-  char *v = getVariable(sys, pid, arg1);
-  if (v)
-    printf("P%d OUTPUT: %s\n", pid, v);
 }
 
-void do_assign(SystemState *sys, int pid, char *varName, char *valueOrInput)
-{
-  if (strcmp(valueOrInput, "input") == 0)
-  {
-    char buf[50];
-    do
-    {
-      printf("P%d: enter value for <%s>: ", pid, varName);
-      fflush(stdout);
-    } while (!fgets(buf, sizeof(buf), stdin) || buf[0] == '\n');
-    buf[strcspn(buf, "\r\n")] = 0;
-    setVariable(sys, pid, varName, buf);
-  }
-  else
-  {
-    setVariable(sys, pid, varName, valueOrInput);
-  }
+static void printLineProfile(SystemState *sys)
+{
+  LineProfile lines[MAX_LINE_PROFILES];
+  int n = getLineProfile(sys, lines, MAX_LINE_PROFILES);
+  long total = 0;
+  for (int i = 0; i < n; i++)
+    total += lines[i].executed;
+  printf("\nProgram hot spots (cycles)\n");
+  printf("%8s %9s %8s %6s %8s  %s\n", "Overhead", "Executed", "Blocked", "Input", "DiskWait", "Line");
+  int shown = n < 20 ? n : 20;
+  for (int i = 0; i < shown; i++)
+    printf("%7.2f%% %9ld %8ld %6ld %8ld  P%d:%d\n", total > 0 ? 100.0 * lines[i].executed / total : 0.0,
+           lines[i].executed, lines[i].blocked, lines[i].inputStalls, lines[i].diskWait, lines[i].programNumber,
+           lines[i].line + 1);
+  if (n > shown)
+    printf("  (%d more lines)\n", n - shown);
+  if (sys->lineProfileDropped > 0)
+    printf("  (%ld cycles and events at further lines not tracked)\n", sys->lineProfileDropped);
 }
 
-void do_writeFile(SystemState *sys, int pid, char *fileVar, char *dataVar)
-{
-  char *fname = getVariable(sys, pid, fileVar);
-  char *data = getVariable(sys, pid, dataVar);
-  if (!fname || !data)
-    return;
-  FILE *f = fopen(fname, "w");
-  if (!f)
-  {
-    perror("writeFile");
-    findPCB(sys, pid)->state = TERMINATED;
-    return;
-  }
-  fprintf(f, "%s", data);
-  fclose(f);
-  printf("P%d wrote '%s' to %s\n", pid, data, fname);
-}
+// ------------- Main -------------
 
-void do_readFile(SystemState *sys, int pid, char *fileVar)
+static bool parseQuantaList(const char *s, SchedulerConfig *cfg)
 {
-  char *fname = getVariable(sys, pid, fileVar);
-  if (!fname)
-    return;
-
-  FILE *f = fopen(fname, "r");
-  if (!f)
-  {
-    perror("readFile");
-    findPCB(sys, pid)->state = TERMINATED;
-    return;
-  }
-
-  char buf[MAX_LINE_LENGTH];
-  char content[500] = "";
-  while (fgets(buf, sizeof(buf), f))
+  int levels = 0;
+  const char *p = s;
+  while (*p && levels < MLFQ_LEVELS)
   {
-    strncat(content, buf, sizeof(content) - strlen(content) - 1);
+    char *endptr;
+    long q = strtol(p, &endptr, 10);
+    if (endptr == p || q < 1)
+      return false;
+    cfg->mlfqQuantum[levels++] = (int)q;
+    p = *endptr == ',' ? endptr + 1 : endptr;
+    if (*endptr != ',' && *endptr != '\0')
+      return false;
   }
-  fclose(f);
-
-  // Build a valid variable name: "file_<originalVarName>"
-  char varName[64];
-  snprintf(varName, sizeof(varName), "file_%s", fileVar);
-
-  setVariable(sys, pid, varName, content);
-  printf("P%d read '%s' -> var %s\n", pid, content, varName);
-}
-
-void do_printFromTo(SystemState *sys, int pid, char *v1, char *v2)
-{
-  char *s1 = getVariable(sys, pid, v1), *s2 = getVariable(sys, pid, v2);
-  if (!s1 || !s2)
-    return;
-  int a = atoi(s1), b = atoi(s2);
-  printf("P%d OUTPUT: ", pid);
-  if (a <= b)
-    for (int x = a; x <= b; x++)
-      printf("%d ", x);
-  else
-    for (int x = a; x >= b; x--)
-      printf("%d ", x);
-  printf("\n");
-}
-
-ResourceType getResourceTypeFromString(const char *s)
-{
-  if (strcmp(s, "file") == 0)
-    return RESOURCE_FILE;
-  if (strcmp(s, "userInput") == 0)
-    return RESOURCE_USER_INPUT;
-  if (strcmp(s, "userOutput") == 0)
-    return RESOURCE_USER_OUTPUT;
-  return -1;
-}
-
-bool enqueueMutexBlocked(Mutex *m, int pid)
-{
-  if (m->size >= MAX_QUEUE_SIZE)
+  if (*p != '\0' || levels == 0)
     return false;
-  m->blockedQueue[m->tail] = pid;
-  m->tail = (m->tail + 1) % MAX_QUEUE_SIZE;
-  m->size++;
+  cfg->mlfqLevels = levels;
   return true;
 }
 
-int dequeueMutexBlocked(Mutex *m)
-{
-  if (m->size == 0)
-    return -1;
-  int pid = m->blockedQueue[m->head];
-  m->head = (m->head + 1) % MAX_QUEUE_SIZE;
-  m->size--;
-  return pid;
-}
-
-void blockProcess(SystemState *sys, int pid, ResourceType r)
+// "buffers[,lru|clock][,exitflush]"
+static bool parseCacheSpec(const char *spec, int *buffers, FsCachePolicy *policy, bool *flushOnExit)
 {
-  PCB *pcb = findPCB(sys, pid);
-  Mutex *m = &sys->mutexes[r];
-  if (!enqueueMutexBlocked(m, pid))
-  {
-    printf("Mutex %d queue full, killing P%d\n", r, pid);
-    pcb->state = TERMINATED;
-    return;
+  char copy[64];
+  snprintf(copy, sizeof(copy), "%s", spec);
+  char *end;
+  *buffers = (int)strtol(copy, &end, 10);
+  if (end == copy || *buffers < 0 || *buffers > FS_CACHE_MAX)
+    return false;
+  for (char *tok = strtok(end, ","); tok; tok = strtok(NULL, ","))
+  {
+    if (strcasecmp(tok, "lru") == 0)
+      *policy = FS_CACHE_LRU;
+    else if (strcasecmp(tok, "clock") == 0)
+      *policy = FS_CACHE_CLOCK;
+    else if (strcasecmp(tok, "exitflush") == 0)
+      *flushOnExit = true;
+    else
+      return false;
   }
-  pcb->state = BLOCKED;
-  pcb->blockedOnResource = r;
-  sys->runningProcessID = -1;
-  printf("P%d BLOCKED on res %d\n", pid, r);
+  return true;
 }
 
-void unblockProcess(SystemState *sys, ResourceType r)
+// "seek,transfer[,policy]"
+static bool parseDiskSpec(const char *spec, int *seek, int *transfer, DiskPolicy *policy)
 {
-  Mutex *m = &sys->mutexes[r];
-  if (m->size == 0)
-    return;
-  // priority-based selection
-  int bestPid = -1, bestPrio = 999, bestIdx = -1;
-  for (int i = 0, idx = m->head; i < m->size; i++)
+  char name[16] = "";
+  int n = sscanf(spec, "%d,%d,%15s", seek, transfer, name);
+  if (n < 2 || *seek < 0 || *transfer < 0)
+    return false;
+  if (n == 2)
+    return true;
+  for (int p = 0; p < (int)(sizeof(diskPolicyNames) / sizeof(diskPolicyNames[0])); p++)
   {
-    int pid = m->blockedQueue[idx];
-    PCB *pcb = findPCB(sys, pid);
-    if (pcb && pcb->priority < bestPrio)
+    if (strcasecmp(name, diskPolicyNames[p]) == 0)
     {
-      bestPrio = pcb->priority;
-      bestPid = pid;
-      bestIdx = idx;
+      *policy = (DiskPolicy)p;
+      return true;
     }
-    idx = (idx + 1) % MAX_QUEUE_SIZE;
-  }
-  if (bestPid < 0)
-    return;
-  // remove from queue
-  int idx = bestIdx;
-  for (int k = 0; k < m->size - 1; k++)
-  {
-    int next = (idx + 1) % MAX_QUEUE_SIZE;
-    m->blockedQueue[idx] = m->blockedQueue[next];
-    idx = next;
-  }
-  m->tail = (m->tail - 1 + MAX_QUEUE_SIZE) % MAX_QUEUE_SIZE;
-  m->size--;
-
-  PCB *pcb = findPCB(sys, bestPid);
-  pcb->state = READY;
-  pcb->blockedOnResource = -1;
-  // enqueue into proper ready queue
-  if (schedulerType == SCHED_MLFQ)
-  {
-    addToMLFQ(sys, bestPid, pcb->mlfqLevel);
-  }
-  else
-  {
-    addToReadyQueue(sys, bestPid);
   }
-  printf("P%d UNBLOCKED from res %d\n", bestPid, (int)r);
+  return false;
 }
 
-void do_semWait(SystemState *sys, int pid, char *resName)
-{
-  ResourceType r = getResourceTypeFromString(resName);
-  if (r < 0)
-  {
-    printf("semWait bad res '%s'\n", resName);
-    findPCB(sys, pid)->state = TERMINATED;
-    return;
+int main(int argc, char **argv)
+{
+  Workload workload = {0};
+  SchedulerConfig cfg;
+  defaultSchedulerConfig(&cfg, SIM_SCHED_FCFS, 2);
+  CliState cli = {OUTPUT_SUMMARY, &workload, 0, NULL};
+  int maxCycles = -1;
+  const char *tracePath = NULL;
+  const char *logLevels = NULL;
+  const char *timelinePath = NULL;
+  const char *inputScriptPath = NULL;
+  const char *fsHostDir = ".";
+  int cacheBuffers = FS_CACHE_DEFAULT;
+  FsCachePolicy cachePolicy = FS_CACHE_LRU;
+  bool cacheFlushOnExit = false;
+  int diskSeek = 0, diskTransfer = 0;
+  DiskPolicy diskPolicy = DISK_FCFS;
+  bool lockReport = false;
+  bool hostReport = false;
+  bool lineReport = false;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "s:q:Q:o:L:T:lpPi:I:F:C:D:c:w:h")) != -1)
+  {
+    switch (opt)
+    {
+    case 's':
+      if (strcasecmp(optarg, "fcfs") == 0)
+        cfg.type = SIM_SCHED_FCFS;
+      else if (strcasecmp(optarg, "rr") == 0)
+        cfg.type = SIM_SCHED_RR;
+      else if (strcasecmp(optarg, "mlfq") == 0)
+        cfg.type = SIM_SCHED_MLFQ;
+      else
+      {
+        usage(argv[0]);
+        return 2;
+      }
+      break;
+    case 'q':
+      cfg.rrQuantum = atoi(optarg);
+      break;
+    case 'Q':
+      if (!parseQuantaList(optarg, &cfg))
+      {
+        fprintf(stderr, "Error: invalid MLFQ quanta list '%s'\n", optarg);
+        return 2;
+      }
+      break;
+    case 'o':
+      if (strcmp(optarg, "quiet") == 0)
+        cli.mode = OUTPUT_QUIET;
+      else if (strcmp(optarg, "summary") == 0)
+        cli.mode = OUTPUT_SUMMARY;
+      else if (strcmp(optarg, "trace") == 0)
+        cli.mode = OUTPUT_TRACE;
+      else
+      {
+        usage(argv[0]);
+        return 2;
+      }
+      break;
+    case 'L':
+      logLevels = optarg;
+      break;
+    case 'l':
+      lockReport = true;
+      break;
+    case 'p':
+      lineReport = true;
+      break;
+    case 'P':
+      hostReport = true;
+      break;
+    case 'T':
+      timelinePath = optarg;
+      break;
+    case 'i':
+      if (!addWorkloadInput(&workload, optarg))
+        return 2;
+      break;
+    case 'I':
+      inputScriptPath = optarg;
+      break;
+    case 'F':
+      fsHostDir = strcmp(optarg, "none") == 0 ? NULL : optarg;
+      break;
+    case 'C':
+      if (!parseCacheSpec(optarg, &cacheBuffers, &cachePolicy, &cacheFlushOnExit))
+      {
+        fprintf(stderr, "Error: invalid cache spec '%s' (buffers 0-%d)\n", optarg, FS_CACHE_MAX);
+        return 2;
+      }
+      break;
+    case 'D':
+      if (!parseDiskSpec(optarg, &diskSeek, &diskTransfer, &diskPolicy))
+      {
+        fprintf(stderr, "Error: invalid disk spec '%s' (expected seek,transfer[,policy])\n", optarg);
+        return 2;
+      }
+      break;
+    case 'c':
+      maxCycles = atoi(optarg);
+      break;
+    case 'w':
+      tracePath = optarg;
+      break;
+    default:
+      usage(argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
   }
-  Mutex *m = &sys->mutexes[r];
-  if (m->locked)
+  for (int i = optind; i < argc; i++)
   {
-    blockProcess(sys, pid, r);
+    if (!addWorkloadProgram(&workload, argv[i]))
+      return 2;
   }
-  else
+  if (workload.count == 0 && !tracePath)
   {
-    m->locked = true;
-    m->lockingProcessID = pid;
-    printf("P%d acquired res %d\n", pid, (int)r);
+    addWorkloadProgram(&workload, "Program_1.txt@0");
+    addWorkloadProgram(&workload, "Program_2.txt@1");
+    addWorkloadProgram(&workload, "Program_3.txt@2");
   }
-}
 
-void do_semSignal(SystemState *sys, int pid, char *resName)
-{
-  ResourceType r = getResourceTypeFromString(resName);
-  if (r < 0)
-  {
-    printf("semSignal bad res '%s'\n", resName);
-    findPCB(sys, pid)->state = TERMINATED;
-    return;
-  }
-  Mutex *m = &sys->mutexes[r];
-  if (m->locked && m->lockingProcessID == pid)
+  // Only trace mode formats log text; the other modes leave log_message NULL
+  GuiCallbacks callbacks = {0};
+  callbacks.request_input = cli_request_input;
+  if (cli.mode != OUTPUT_QUIET)
+    callbacks.process_output = cli_process_output;
+  if (cli.mode == OUTPUT_TRACE)
+    callbacks.log_message = cli_log_message;
+
+  static SystemState sys;
+  cli.sys = &sys;
+  initializeSystem(&sys, cfg.type, cfg.rrQuantum, &callbacks, &cli);
+  if (cfg.type == SIM_SCHED_MLFQ)
+    setMLFQConfig(&sys, cfg.mlfqLevels, cfg.mlfqQuantum);
+  if (logLevels && !parseLogLevels(&sys, logLevels))
   {
-    m->locked = false;
-    m->lockingProcessID = -1;
-    printf("P%d released res %d\n", pid, (int)r);
-    unblockProcess(sys, r);
+    fprintf(stderr, "Error: invalid log levels '%s'\n", logLevels);
+    return 2;
   }
-  else
+  setFsHostDir(&sys, fsHostDir, true);
+  setFsCache(&sys, cacheBuffers, cachePolicy, cacheFlushOnExit);
+  setDiskModel(&sys, diskSeek, diskTransfer);
+  setDiskPolicy(&sys, diskPolicy);
+  InputScript script;
+  inputScriptInit(&script);
+  if (inputScriptPath)
   {
-    printf("P%d illegal semSignal on res %d\n", pid, (int)r);
-    findPCB(sys, pid)->state = TERMINATED;
-  }
-}
-
-// ------ Arrival & Simulation Loop ------
-
-void checkArrivals(SystemState *sys)
-{
-  for (int i = 0; i < sys->processCount; i++)
-  {
-    PCB *pcb = &sys->processTable[i];
-    if (pcb->state == NEW && pcb->arrivalTime <= sys->clockCycle)
+    int bad = inputScriptLoad(&script, inputScriptPath);
+    if (bad != 0)
     {
-      if (schedulerType == SCHED_MLFQ)
-        addToMLFQ(sys, i, 0);
+      if (bad < 0)
+        fprintf(stderr, "Error: cannot open input script '%s'\n", inputScriptPath);
       else
-        addToReadyQueue(sys, i);
-      pcb->state = READY;
-      printf("Clock %d: P%d arrived\n", sys->clockCycle, i);
+        fprintf(stderr, "Error: %s:%d: expected '<program|*> <variable|*> <value>'\n", inputScriptPath, bad);
+      return 2;
     }
+    setInputScript(&sys, &script);
   }
-}
-
-void runSimulation(SystemState *sys)
-{
-  int completed = 0;
-  printf("Starting simulation with %s scheduler\n",
-         schedulerType == SCHED_FCFS ? "FCFS" : schedulerType == SCHED_RR ? "RR"
-                                                                          : "MLFQ");
 
-  while (completed < sys->processCount)
+  // The timeline is built from typed engine events, drained into the writer as they accumulate
+  static TraceWriter timeline;
+  EventLog events;
+  eventLogInit(&events);
+  if (timelinePath)
   {
-    printf("\n--- Cycle %d ---\n", sys->clockCycle);
-    checkArrivals(sys);
-
-    // Dispatch if CPU idle
-    if (sys->runningProcessID < 0)
-    {
-      int next;
-      if (schedulerType == SCHED_MLFQ)
-        next = scheduleMLFQ(sys);
-      else
-        next = scheduleFCFS(sys);
-      if (next >= 0)
-      {
-        PCB *pcb = findPCB(sys, next);
-        pcb->state = RUNNING;
-        if (schedulerType == SCHED_RR)
-        {
-          pcb->quantumRemaining = rrQuantum;
-        }
-        else if (schedulerType == SCHED_MLFQ)
-        {
-          pcb->priority = pcb->mlfqLevel;
-          pcb->quantumRemaining = mlfqQuantum[pcb->mlfqLevel];
-        }
-        sys->runningProcessID = next;
-        printf("Scheduler: P%d → RUNNING\n", next);
-      }
-      else
-      {
-        printf("Scheduler: CPU idle\n");
-      }
-    }
-    else
+    if (!traceWriterOpen(&timeline, timelinePath))
     {
-      printf("CPU continues P%d\n", sys->runningProcessID);
+      fprintf(stderr, "Error: could not create '%s': %s\n", timelinePath, strerror(errno));
+      return 1;
     }
-
-    // Execute one instruction
-    if (sys->runningProcessID >= 0)
+    if (!logLevels)
+      setLogLevel(&sys, SIM_LOG_ALL, SIM_LOG_INFO); // Per-cycle detail is not needed for the timeline
+    static const SimLogCategory needed[] = {SIM_LOG_SCHED, SIM_LOG_INTERP, SIM_LOG_MEMORY, SIM_LOG_SYNC};
+    for (size_t i = 0; i < sizeof(needed) / sizeof(needed[0]); i++)
     {
-      PCB *pcb = findPCB(sys, sys->runningProcessID);
-      interpretInstruction(sys, pcb->processID);
-
-      // handle post‐execution
-      if (pcb->state == TERMINATED)
-      {
-        printf("P%d terminated\n", pcb->processID);
-        completed++;
-        sys->runningProcessID = -1;
-      }
-      else if (pcb->state == BLOCKED)
-      {
-        // already moved to blocked queue
-      }
-      else if (pcb->state == RUNNING)
-      {
-        // advance PC
-        pcb->programCounter++;
-
-        // Check if process has finished after incrementing PC
-        int instCount = findInstructionCount(sys, pcb->processID);
-        if (pcb->programCounter >= instCount)
-        {
-          pcb->state = TERMINATED;
-          printf("P%d done\n", pcb->processID);
-          printf("P%d terminated\n", pcb->processID);
-          completed++;
-          sys->runningProcessID = -1;
-        }
-        else
-        {
-          // quantum handling
-          if (schedulerType == SCHED_RR)
-          {
-            pcb->quantumRemaining--;
-            if (pcb->quantumRemaining <= 0)
-            {
-              printf("P%d quantum expired\n", pcb->processID);
-              pcb->state = READY;
-              addToReadyQueue(sys, pcb->processID);
-              sys->runningProcessID = -1;
-            }
-          }
-          else if (schedulerType == SCHED_MLFQ)
-          {
-            pcb->quantumRemaining--;
-            if (pcb->quantumRemaining <= 0)
-            {
-              printf("P%d MLFQ quantum expired at level %d\n",
-                     pcb->processID, pcb->mlfqLevel);
-              pcb->state = READY;
-              int nl = pcb->mlfqLevel < MLFQ_LEVELS - 1 ? pcb->mlfqLevel + 1 : pcb->mlfqLevel;
-              addToMLFQ(sys, pcb->processID, nl);
-              sys->runningProcessID = -1;
-            }
-          }
-        }
-      }
+      if (sys.logLevel[needed[i]] < SIM_LOG_INFO)
+        setLogLevel(&sys, needed[i], SIM_LOG_INFO);
     }
+    setEventLog(&sys, &events);
+  }
 
-    sys->clockCycle++;
-    if (sys->clockCycle > 1000)
+  for (int i = 0; i < workload.count; i++)
+  {
+    if (!loadProgramAt(&sys, workload.programs[i].path, workload.programs[i].arrivalTime))
     {
-      printf("Safety break\n");
-      break;
+      fprintf(stderr, "Error: could not load '%s'\n", workload.programs[i].path);
+      return 1;
     }
   }
-  printf("\nSimulation complete in %d cycles\n", sys->clockCycle);
-}
-
-// --------------------- main ---------------------
-
-int main()
-{
-  char line[128];
-  int choice;
-
-  // 1) Choose scheduler
-  printf("Choose scheduler (1=FCFS, 2=RR, 3=MLFQ): ");
-  if (!fgets(line, sizeof(line), stdin))
+  if (tracePath && !openWorkloadTrace(&sys, tracePath))
   {
-    fprintf(stderr, "Input error\n");
+    fprintf(stderr, "Error: could not open trace '%s'\n", tracePath);
     return 1;
   }
-  choice = atoi(line);
-  if (choice < 1 || choice > 3)
-    choice = 1; // default FCFS
 
-  // 2) If RR, ask for quantum
-  if (choice == 2)
+  char inputBuf[MAX_LINE_LENGTH];
+  while (!isSimulationComplete(&sys) && (maxCycles < 0 || sys.clockCycle < maxCycles))
   {
-    schedulerType = SCHED_RR;
-    printf("Enter RR quantum: ");
-    if (!fgets(line, sizeof(line), stdin))
+    stepSimulation(&sys);
+    if (events.count >= 4096)
     {
-      fprintf(stderr, "Input error\n");
-      return 1;
+      traceWriterAdd(&timeline, &events);
+      eventLogClear(&events);
+    }
+    if (sys.needsInput)
+    {
+      provideInput(&sys, nextInputValue(&cli, &sys, inputBuf, sizeof(inputBuf)));
     }
-    rrQuantum = atoi(line);
-    if (rrQuantum < 1)
-      rrQuantum = 1;
   }
-  else if (choice == 3)
+
+  if (cli.mode != OUTPUT_QUIET)
+    printSummary(&sys);
+  if (lockReport)
+    printLockReport(&sys);
+  if (lineReport)
+    printLineProfile(&sys);
+  if (hostReport)
   {
-    schedulerType = SCHED_MLFQ;
+    char profile[2048];
+    formatHostProfile(&sys, profile, sizeof(profile));
+    printf("\n%s", profile);
   }
-  else
+  bool complete = isSimulationComplete(&sys);
+  if (!complete)
+    fsExport(&sys); // Stopped early; completion writes the files back itself
+  closeWorkloadTrace(&sys);
+  if (timelinePath)
   {
-    schedulerType = SCHED_FCFS;
+    traceWriterAdd(&timeline, &events);
+    if (!traceWriterClose(&timeline, sys.clockCycle))
+    {
+      fprintf(stderr, "Error: could not write '%s'\n", timelinePath);
+      complete = false;
+    }
   }
-
-  // 3) Initialize & load
-  initializeSystem(&osSystem);
-  loadProgram(&osSystem, "Program_1.txt", 0);
-  loadProgram(&osSystem, "Program_2.txt", 1);
-  loadProgram(&osSystem, "Program_3.txt", 2);
-
-  // 4) Run
-  runSimulation(&osSystem);
-  return 0;
-}
\ No newline at end of file
+  eventLogFree(&events);
+  inputScriptFree(&script);
+  return complete ? 0 : 1;
+}
@@ -0,0 +1,349 @@
+// microbench.c
+// Microbenchmarks for the engine's hot internal functions. simulator.c is compiled
+// into this translation unit so its static helpers can be timed in isolation.
+// Reports ns/op and heap allocations per op for a range of table and queue sizes.
+
+#include "simulator.c"
+#include <time.h>
+#include <unistd.h> // For getopt
+
+// ------------- Allocation Counting -------------
+
+// On glibc every malloc in the process (including inside libc, e.g. vsnprintf)
+// goes through these wrappers; elsewhere allocation counts are reported as -1.
+#ifdef __GLIBC__
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static unsigned long allocationCount;
+
+void *malloc(size_t size)
+{
+  allocationCount++;
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+  allocationCount++;
+  return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+  allocationCount++;
+  return __libc_realloc(ptr, size);
+}
+#define ALLOCATIONS_COUNTED 1
+#else
+static unsigned long allocationCount;
+#define ALLOCATIONS_COUNTED 0
+#endif
+
+// ------------- Harness -------------
+
+typedef void (*MicroOp)(SystemState *sys, int size);
+typedef void (*MicroSetup)(SystemState *sys, int size);
+
+static volatile int sink; // Keeps results observable so calls are not optimized away
+static double minSeconds = 0.05;
+static bool jsonOutput = false;
+static bool firstResult = true;
+
+static double nowSeconds(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Doubles the iteration count until one timed batch lasts at least minSeconds
+static void runMicro(const char *name, int size, MicroSetup setup, MicroOp op)
+{
+  static SystemState sys;
+  setup(&sys, size);
+
+  long iterations = 1;
+  double elapsed = 0;
+  unsigned long allocs = 0;
+  for (;;)
+  {
+    unsigned long allocsBefore = allocationCount;
+    double start = nowSeconds();
+    for (long i = 0; i < iterations; i++)
+      op(&sys, size);
+    elapsed = nowSeconds() - start;
+    allocs = allocationCount - allocsBefore;
+    if (elapsed >= minSeconds || iterations >= (1L << 40))
+      break;
+    iterations *= 2;
+  }
+
+  double nsPerOp = elapsed * 1e9 / iterations;
+  double allocsPerOp = ALLOCATIONS_COUNTED ? (double)allocs / iterations : -1;
+  if (jsonOutput)
+  {
+    printf("%s  {\"benchmark\": \"%s\", \"size\": %d, \"iterations\": %ld, \"ns_per_op\": %.2f, "
+           "\"allocs_per_op\": %.3f}",
+           firstResult ? "" : ",\n", name, size, iterations, nsPerOp, allocsPerOp);
+  }
+  else
+  {
+    printf("%s,%d,%ld,%.2f,%.3f\n", name, size, iterations, nsPerOp, allocsPerOp);
+  }
+  firstResult = false;
+  fflush(stdout);
+}
+
+// ------------- Fixtures -------------
+
+static void discardLog(void *data, const char *message)
+{
+  (void)data;
+  sink += message[0];
+}
+
+static GuiCallbacks silentCallbacks;  // All entries NULL: log events discarded unformatted
+static GuiCallbacks loggingCallbacks; // No-op logger: every event is formatted
+static EventLog recordedEvents;       // Typed records appended, never formatted
+
+// One process whose program has `lines` instructions followed by its variables
+static void setupProgram(SystemState *sys, int lines)
+{
+  initializeSystem(sys, SIM_SCHED_FCFS, 2, &silentCallbacks, NULL);
+  sys->processCount = 1;
+  PCB *pcb = &sys->processTable[0];
+  pcb->processID = 0;
+  pcb->state = READY;
+  pcb->memoryLowerBound = 0;
+  pcb->memoryUpperBound = lines + NUM_VARIABLES + PCB_SIZE - 1;
+  for (int i = 0; i < lines; i++)
+  {
+    snprintf(sys->memory[i].name, sizeof(sys->memory[i].name), "Inst_0_%d", i);
+    snprintf(sys->memory[i].value, sizeof(sys->memory[i].value), "assign a %d", i);
+  }
+  // First two variable slots used, the last one free
+  snprintf(sys->memory[lines].name, sizeof(sys->memory[0].name), "Var_0_a");
+  snprintf(sys->memory[lines + 1].name, sizeof(sys->memory[0].name), "Var_0_b");
+  snprintf(sys->memory[lines + 2].name, sizeof(sys->memory[0].name), "Var_0_Free");
+}
+
+// `size` processes with distinct priorities, all blocked on the file mutex;
+// the highest-priority one sits in the middle of the queue
+static void setupMutexQueue(SystemState *sys, int size)
+{
+  initializeSystem(sys, SIM_SCHED_MLFQ, 2, &silentCallbacks, NULL);
+  sys->processCount = size;
+  Mutex *m = &sys->mutexes[RESOURCE_FILE];
+  for (int i = 0; i < size; i++)
+  {
+    sys->processTable[i].processID = i;
+    sys->processTable[i].state = BLOCKED;
+    sys->processTable[i].priority = (i == size / 2) ? 0 : 1 + i % (MLFQ_LEVELS - 1);
+    enqueueMutexBlocked(m, i);
+  }
+}
+
+// `size` - 1 processes queued on MLFQ level 0, plus one unblocked this cycle
+static void setupMLFQ(SystemState *sys, int size)
+{
+  initializeSystem(sys, SIM_SCHED_MLFQ, 2, &silentCallbacks, NULL);
+  sys->processCount = size;
+  for (int i = 0; i < size; i++)
+  {
+    sys->processTable[i].processID = i;
+    if (i < size - 1)
+      addToMLFQ(sys, i, 0);
+  }
+  sys->wasUnblockedThisCycle[size - 1] = true;
+}
+
+// `size` processes that have all arrived already (the steady-state scan)
+static void setupArrivals(SystemState *sys, int size)
+{
+  initializeSystem(sys, SIM_SCHED_FCFS, 2, &silentCallbacks, NULL);
+  sys->processCount = size;
+  for (int i = 0; i < size; i++)
+  {
+    sys->processTable[i].processID = i;
+    sys->processTable[i].state = i % 2 ? READY : BLOCKED;
+  }
+  sys->clockCycle = 100;
+}
+
+static void setupSilentLog(SystemState *sys, int size)
+{
+  (void)size;
+  initializeSystem(sys, SIM_SCHED_FCFS, 2, &silentCallbacks, NULL);
+}
+
+static void setupFormattedLog(SystemState *sys, int size)
+{
+  (void)size;
+  initializeSystem(sys, SIM_SCHED_FCFS, 2, &loggingCallbacks, NULL);
+}
+
+// Formatting logger attached, but the categories filtered out at the emission site
+static void setupFilteredLog(SystemState *sys, int size)
+{
+  (void)size;
+  initializeSystem(sys, SIM_SCHED_FCFS, 2, &loggingCallbacks, NULL);
+  setLogLevel(sys, SIM_LOG_ALL, SIM_LOG_WARN);
+}
+
+static void setupRecordedLog(SystemState *sys, int size)
+{
+  (void)size;
+  initializeSystem(sys, SIM_SCHED_FCFS, 2, &silentCallbacks, NULL);
+  eventLogClear(&recordedEvents);
+  setEventLog(sys, &recordedEvents);
+}
+
+// ------------- Operations -------------
+
+static void opFindInstructionCount(SystemState *sys, int size)
+{
+  (void)size;
+  sink += findInstructionCount(sys, 0);
+}
+
+static void opFindVariableHit(SystemState *sys, int size)
+{
+  (void)size;
+  sink += findVariableMemoryIndex(sys, 0, "b", false);
+}
+
+static void opFindVariableFree(SystemState *sys, int size)
+{
+  (void)size;
+  sink += findVariableMemoryIndex(sys, 0, "c", true);
+}
+
+// Dequeue the highest-priority waiter and requeue it so the queue size stays constant
+static void opDequeueMutex(SystemState *sys, int size)
+{
+  (void)size;
+  Mutex *m = &sys->mutexes[RESOURCE_FILE];
+  int pid = dequeueMutexBlocked(sys, m);
+  enqueueMutexBlocked(m, pid);
+  sink += pid;
+}
+
+// Head insertion of the unblocked process, then dispatch it again
+static void opMLFQHeadInsert(SystemState *sys, int size)
+{
+  addToMLFQ(sys, size - 1, 0);
+  sink += scheduleNextProcess(sys);
+}
+
+static void opCheckArrivals(SystemState *sys, int size)
+{
+  (void)size;
+  checkArrivals(sys);
+  sink += sys->readySize;
+}
+
+static void opLog(SystemState *sys, int size)
+{
+  (void)size;
+  sim_log(sys, SIM_LOG_INTERP, SIM_LOG_DEBUG, "Clock %d: P%d executing instruction %d: '%s'", sys->clockCycle, 3, 17, "assign a input");
+}
+
+// The most frequent event: one per interpreted instruction, carrying the instruction text
+static void opEvent(SystemState *sys, int size)
+{
+  (void)size;
+  if (sys->eventLog && sys->eventLog->count >= 4096)
+    eventLogClear(sys->eventLog); // Bounded memory; clearing keeps the buffers
+  sim_event(sys, SIM_EV_EXECUTE, 3, 3, 17, 0, 0, "assign a input");
+}
+
+// ------------- Main -------------
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  -f format   csv (default) or json\n"
+          "  -t seconds  minimum measured time per benchmark point (default 0.05)\n"
+          "  -b name     only run benchmarks whose name contains this text\n",
+          prog);
+}
+
+int main(int argc, char **argv)
+{
+  const char *filter = NULL;
+  int opt;
+  while ((opt = getopt(argc, argv, "f:t:b:h")) != -1)
+  {
+    switch (opt)
+    {
+    case 'f':
+      jsonOutput = strcmp(optarg, "json") == 0;
+      break;
+    case 't':
+      minSeconds = atof(optarg);
+      break;
+    case 'b':
+      filter = optarg;
+      break;
+    default:
+      usage(argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+  loggingCallbacks.log_message = discardLog;
+
+  static const struct
+  {
+    const char *name;
+    MicroSetup setup;
+    MicroOp op;
+    bool sizedByProgram; // size = program lines, otherwise number of processes
+  } benchmarks[] = {
+      {"findInstructionCount", setupProgram, opFindInstructionCount, true},
+      {"findVariableMemoryIndex/hit", setupProgram, opFindVariableHit, true},
+      {"findVariableMemoryIndex/free", setupProgram, opFindVariableFree, true},
+      {"dequeueMutexBlocked", setupMutexQueue, opDequeueMutex, false},
+      {"addToMLFQ/head", setupMLFQ, opMLFQHeadInsert, false},
+      {"checkArrivals", setupArrivals, opCheckArrivals, false},
+      {"sim_log/discarded", setupSilentLog, opLog, false},
+      {"sim_log/formatted", setupFormattedLog, opLog, false},
+      {"sim_log/filtered", setupFilteredLog, opLog, false},
+      {"sim_event/discarded", setupSilentLog, opEvent, false},
+      {"sim_event/formatted", setupFormattedLog, opEvent, false},
+      {"sim_event/recorded", setupRecordedLog, opEvent, false},
+      {"sim_event/filtered", setupFilteredLog, opEvent, false},
+  };
+  static const int sizes[] = {1, 2, 4, 8, 16, 32, 64, 128, 256};
+
+  if (jsonOutput)
+    printf("[\n");
+  else
+    printf("benchmark,size,iterations,ns_per_op,allocs_per_op\n");
+
+  for (size_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); b++)
+  {
+    if (filter && !strstr(benchmarks[b].name, filter))
+      continue;
+    bool logOnly = benchmarks[b].setup == setupSilentLog || benchmarks[b].setup == setupFormattedLog ||
+                   benchmarks[b].setup == setupFilteredLog || benchmarks[b].setup == setupRecordedLog;
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+      int size = sizes[s];
+      int limit = benchmarks[b].sizedByProgram
+                      ? (MAX_PROGRAM_LINES < MEMORY_SIZE - NUM_VARIABLES - PCB_SIZE ? MAX_PROGRAM_LINES
+                                                                                     : MEMORY_SIZE - NUM_VARIABLES - PCB_SIZE)
+                      : (MAX_PROCESSES < MAX_QUEUE_SIZE ? MAX_PROCESSES : MAX_QUEUE_SIZE);
+      if (size > limit)
+        break;
+      runMicro(benchmarks[b].name, size, benchmarks[b].setup, benchmarks[b].op);
+      if (logOnly)
+        break; // Logging cost does not depend on table sizes
+    }
+  }
+  if (jsonOutput)
+    printf("\n]\n");
+  return 0;
+}
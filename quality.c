@@ -0,0 +1,414 @@
+// quality.c
+// Scheduling-quality suite: generates canonical workloads (CPU-bound, I/O-bound,
+// mixed, convoy, lock contention) as Program_N.txt files, runs each under FCFS,
+// RR and MLFQ and reports turnaround, waiting and response time, CPU utilization,
+// context switches and Jain's fairness index. File writes in the I/O workloads wait
+// for a simulated disk; a disk-bound workload then runs under RR with each disk
+// scheduling policy and reports head movement and disk wait. Optional regression
+// thresholds make the exit status fail when a metric crosses its limit.
+//
+// Thresholds file (one rule per line, '#' starts a comment, '*' matches anything):
+//   convoy FCFS response <= 12
+//   * MLFQ fairness >= 0.5
+//   disk sstf seek <= 20     (for the disk workload the second field is the disk policy)
+// Metrics: cycles, turnaround, waiting, response, utilization, switches, fairness,
+//          seek (tracks per disk request), diskwait (mean cycles per disk request)
+
+#include "batch.h"
+#include <sys/stat.h> // For mkdir
+#include <unistd.h>   // For getopt, chdir, rmdir
+
+#define QUALITY_MAX_RULES 128
+#define QUALITY_SCHEDULERS 3
+#define QUALITY_DISK_POLICIES 5
+#define QUALITY_DISK_SEEK 1     // Cycles per track
+#define QUALITY_DISK_TRANSFER 2 // Cycles per block
+
+typedef enum
+{
+  PROG_CPU,  // Straight-line computation
+  PROG_IO,   // Short computation between file writes and prints, each under its lock
+  PROG_LOCK, // Long critical section on the file lock
+  PROG_DISK  // Back-to-back writes alternating between two files
+} ProgramKind;
+
+typedef struct
+{
+  ProgramKind kind;
+  int memoryShare; // Memory words this program may occupy
+  int arrivalTime;
+} ProgramTemplate;
+
+typedef struct
+{
+  const char *name;
+  ProgramTemplate programs[4];
+  int count;
+  bool disk; // File instructions wait for the quality disk, with no buffer cache in between
+} QualityWorkload;
+
+typedef struct
+{
+  char workload[32];
+  char scheduler[16];
+  char metric[16];
+  bool atMost; // "<=" (true) or ">=" (false)
+  double limit;
+} ThresholdRule;
+
+static const char *metricNames[] = {"cycles",   "turnaround", "waiting", "response", "utilization",
+                                    "switches", "fairness",   "seek",    "diskwait"};
+static const char *schedulerNames[QUALITY_SCHEDULERS] = {"FCFS", "RR", "MLFQ"};
+static const char *diskPolicyNames[QUALITY_DISK_POLICIES] = {"fcfs", "sstf", "scan", "cscan", "clook"};
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  -f format   table (default) or csv\n"
+          "  -T file     regression thresholds; exit status 1 if any rule fails\n"
+          "  -d dir      write the generated workloads to dir and keep them\n"
+          "  -q quantum  RR quantum (default 2)\n"
+          "  -c cycles   cycle limit per run (default 10000)\n",
+          prog);
+}
+
+// ------------- Workload Generation -------------
+
+// The canonical suite, sized from MEMORY_SIZE so every workload fits in memory
+static int buildSuite(QualityWorkload *suite)
+{
+  int third = MEMORY_SIZE / 3;
+  int half = MEMORY_SIZE / 2;
+  QualityWorkload defs[] = {
+      {"cpu", {{PROG_CPU, third, 0}, {PROG_CPU, third, 1}, {PROG_CPU, third, 2}}, 3, false},
+      {"io", {{PROG_IO, third, 0}, {PROG_IO, third, 1}, {PROG_IO, third, 2}}, 3, true},
+      {"mixed", {{PROG_CPU, third, 0}, {PROG_IO, third, 0}, {PROG_IO, third, 1}}, 3, true},
+      {"convoy", {{PROG_CPU, half, 0}, {PROG_CPU, half / 2, 1}, {PROG_CPU, half / 2, 2}}, 3, false},
+      {"lock", {{PROG_LOCK, third, 0}, {PROG_LOCK, third, 0}, {PROG_LOCK, third, 1}}, 3, false},
+  };
+  int n = (int)(sizeof(defs) / sizeof(defs[0]));
+  memcpy(suite, defs, sizeof(defs));
+  return n;
+}
+
+static int programLines(int memoryShare)
+{
+  int lines = memoryShare - NUM_VARIABLES - PCB_SIZE;
+  return lines > MAX_PROGRAM_LINES ? MAX_PROGRAM_LINES : lines;
+}
+
+// Writes dir/Program_<number>.txt; I/O programs write "<workload>_<number>.tmp" in the working directory
+static bool writeProgram(const char *dir, const char *workload, int number, const ProgramTemplate *t)
+{
+  char path[BATCH_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s/Program_%d.txt", dir, number);
+  FILE *f = fopen(path, "w");
+  if (!f)
+  {
+    fprintf(stderr, "Error: cannot write '%s': %s\n", path, strerror(errno));
+    return false;
+  }
+
+  int lines = programLines(t->memoryShare);
+  int n = 0;
+  switch (t->kind)
+  {
+  case PROG_CPU:
+    for (; n < lines; n++)
+      fprintf(f, "assign %c %d\n", 'a' + n % 2, n);
+    break;
+  case PROG_IO:
+    fprintf(f, "assign f %s_%d.tmp\nassign d %d\n", workload, number, number);
+    for (n = 2; n + 7 <= lines; n += 7)
+      fprintf(f, "semWait file\nwriteFile f d\nsemSignal file\nassign d %d\n"
+                 "semWait userOutput\nprint d\nsemSignal userOutput\n",
+              n);
+    for (; n < lines; n++)
+      fprintf(f, "print d\n");
+    break;
+  case PROG_DISK:
+    fprintf(f, "assign f %s_%d.tmp\nassign g %s_%d.tmp\nassign d %d\n", workload, number, workload,
+            number + MAX_PROCESSES, number);
+    for (n = 3; n < lines; n++)
+      fprintf(f, "writeFile %c d\n", n % 2 ? 'f' : 'g');
+    break;
+  case PROG_LOCK:
+  {
+    int critical = lines / 2;
+    fprintf(f, "semWait file\n");
+    for (n = 1; n < critical; n++)
+      fprintf(f, "assign %c %d\n", 'a' + n % 2, n);
+    fprintf(f, "semSignal file\n");
+    for (n++; n < lines; n++)
+      fprintf(f, "assign %c %d\n", 'a' + n % 2, n);
+    break;
+  }
+  }
+  fclose(f);
+  return true;
+}
+
+static bool writeWorkload(const QualityWorkload *qw, Workload *out)
+{
+  memset(out, 0, sizeof(*out));
+  if (mkdir(qw->name, 0755) != 0 && errno != EEXIST)
+  {
+    fprintf(stderr, "Error: cannot create '%s': %s\n", qw->name, strerror(errno));
+    return false;
+  }
+  for (int i = 0; i < qw->count; i++)
+  {
+    if (!writeProgram(qw->name, qw->name, i + 1, &qw->programs[i]))
+      return false;
+    char spec[BATCH_PATH_LENGTH];
+    snprintf(spec, sizeof(spec), "%s/Program_%d.txt@%d", qw->name, i + 1, qw->programs[i].arrivalTime);
+    if (!addWorkloadProgram(out, spec))
+      return false;
+  }
+  if (qw->disk)
+  {
+    out->diskSeek = QUALITY_DISK_SEEK;
+    out->diskTransfer = QUALITY_DISK_TRANSFER;
+    out->uncached = true;
+  }
+  return true;
+}
+
+static void removeWorkload(const QualityWorkload *qw, bool keepPrograms)
+{
+  char path[BATCH_PATH_LENGTH];
+  for (int i = 0; i < qw->count; i++)
+  {
+    snprintf(path, sizeof(path), "%s_%d.tmp", qw->name, i + 1);
+    remove(path);
+    snprintf(path, sizeof(path), "%s_%d.tmp", qw->name, i + 1 + MAX_PROCESSES);
+    remove(path);
+    if (!keepPrograms)
+    {
+      snprintf(path, sizeof(path), "%s/Program_%d.txt", qw->name, i + 1);
+      remove(path);
+    }
+  }
+  if (!keepPrograms)
+    rmdir(qw->name);
+}
+
+// ------------- Thresholds -------------
+
+static double metricValue(const RunResult *r, const char *metric)
+{
+  if (strcmp(metric, "cycles") == 0)
+    return r->cycles;
+  if (strcmp(metric, "turnaround") == 0)
+    return r->avgTurnaround;
+  if (strcmp(metric, "waiting") == 0)
+    return r->avgWaiting;
+  if (strcmp(metric, "response") == 0)
+    return r->avgResponse;
+  if (strcmp(metric, "utilization") == 0)
+    return r->cpuUtilization;
+  if (strcmp(metric, "switches") == 0)
+    return r->contextSwitches;
+  if (strcmp(metric, "seek") == 0)
+    return r->avgSeek;
+  if (strcmp(metric, "diskwait") == 0)
+    return r->diskWaitHistogram.count > 0 ? (double)r->diskWaitHistogram.sum / r->diskWaitHistogram.count : 0;
+  return r->fairness;
+}
+
+static int loadThresholds(const char *path, ThresholdRule *rules)
+{
+  FILE *f = fopen(path, "r");
+  if (!f)
+  {
+    fprintf(stderr, "Error: cannot open thresholds '%s': %s\n", path, strerror(errno));
+    return -1;
+  }
+  char line[256];
+  int count = 0, lineNo = 0;
+  while (fgets(line, sizeof(line), f))
+  {
+    lineNo++;
+    char *hash = strchr(line, '#');
+    if (hash)
+      *hash = '\0';
+    char op[4];
+    ThresholdRule r;
+    int fields = sscanf(line, "%31s %15s %15s %3s %lf", r.workload, r.scheduler, r.metric, op, &r.limit);
+    if (fields <= 0)
+      continue; // Blank or comment
+    bool knownMetric = false;
+    for (size_t m = 0; m < sizeof(metricNames) / sizeof(metricNames[0]); m++)
+      knownMetric = knownMetric || strcmp(r.metric, metricNames[m]) == 0;
+    if (fields != 5 || !knownMetric || (strcmp(op, "<=") != 0 && strcmp(op, ">=") != 0) ||
+        count >= QUALITY_MAX_RULES)
+    {
+      fprintf(stderr, "Error: %s:%d: invalid threshold rule\n", path, lineNo);
+      fclose(f);
+      return -1;
+    }
+    r.atMost = op[0] == '<';
+    rules[count++] = r;
+  }
+  fclose(f);
+  return count;
+}
+
+// Checks every matching rule, prints failures and returns how many failed
+static int checkThresholds(const ThresholdRule *rules, int ruleCount, const char *workload, const char *scheduler,
+                           const RunResult *r)
+{
+  int failures = 0;
+  for (int i = 0; i < ruleCount; i++)
+  {
+    const ThresholdRule *rule = &rules[i];
+    if ((strcmp(rule->workload, "*") != 0 && strcmp(rule->workload, workload) != 0) ||
+        (strcmp(rule->scheduler, "*") != 0 && strcmp(rule->scheduler, scheduler) != 0))
+      continue;
+    double value = metricValue(r, rule->metric);
+    bool ok = rule->atMost ? value <= rule->limit : value >= rule->limit;
+    if (!ok)
+    {
+      fprintf(stderr, "FAIL %s %s %s = %.3f (limit %s %g)\n", workload, scheduler, rule->metric, value,
+              rule->atMost ? "<=" : ">=", rule->limit);
+      failures++;
+    }
+  }
+  return failures;
+}
+
+// ------------- Main -------------
+
+int main(int argc, char **argv)
+{
+  bool csv = false;
+  const char *thresholdsPath = NULL;
+  const char *outDir = NULL;
+  int rrQuantum = 2;
+  int maxCycles = 10000;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "f:T:d:q:c:h")) != -1)
+  {
+    switch (opt)
+    {
+    case 'f':
+      csv = strcmp(optarg, "csv") == 0;
+      break;
+    case 'T':
+      thresholdsPath = optarg;
+      break;
+    case 'd':
+      outDir = optarg;
+      break;
+    case 'q':
+      rrQuantum = atoi(optarg);
+      break;
+    case 'c':
+      maxCycles = atoi(optarg);
+      break;
+    default:
+      usage(argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+
+  static ThresholdRule rules[QUALITY_MAX_RULES];
+  int ruleCount = 0;
+  if (thresholdsPath && (ruleCount = loadThresholds(thresholdsPath, rules)) < 0)
+    return 2;
+
+  // Workloads are generated under outDir, or a scratch directory removed afterwards
+  char scratch[] = "/tmp/minisimquality.XXXXXX";
+  char cwd[4096];
+  if (!getcwd(cwd, sizeof(cwd)))
+    return 1;
+  if (outDir && mkdir(outDir, 0755) != 0 && errno != EEXIST)
+  {
+    fprintf(stderr, "Error: cannot create '%s': %s\n", outDir, strerror(errno));
+    return 1;
+  }
+  const char *root = outDir ? outDir : mkdtemp(scratch);
+  if (!root || chdir(root) != 0)
+  {
+    fprintf(stderr, "Error: cannot enter workload directory: %s\n", strerror(errno));
+    return 1;
+  }
+
+  if (csv)
+    printf("workload,scheduler,completed,cycles,turnaround,waiting,response,utilization,switches,fairness\n");
+  else
+    printf("%-8s %-6s %7s %10s %8s %8s %11s %8s %8s\n", "Workload", "Sched", "Cycles", "Turnaround", "Waiting",
+           "Response", "Utilization", "Switches", "Fairness");
+
+  QualityWorkload suite[8];
+  int suiteCount = buildSuite(suite);
+  int failures = 0;
+  int status = 0;
+  for (int w = 0; w < suiteCount; w++)
+  {
+    Workload workload;
+    if (!writeWorkload(&suite[w], &workload))
+    {
+      status = 1;
+      break;
+    }
+    for (int s = 0; s < QUALITY_SCHEDULERS; s++)
+    {
+      SchedulerConfig cfg;
+      defaultSchedulerConfig(&cfg, (SchedulerType)s, rrQuantum);
+      RunResult r;
+      runWorkload(&workload, &cfg, maxCycles, &r);
+      if (csv)
+        printf("%s,%s,%d,%d,%.3f,%.3f,%.3f,%.4f,%d,%.4f\n", suite[w].name, schedulerNames[s], r.completed, r.cycles,
+               r.avgTurnaround, r.avgWaiting, r.avgResponse, r.cpuUtilization, r.contextSwitches, r.fairness);
+      else
+        printf("%-8s %-6s %7d %10.2f %8.2f %8.2f %10.1f%% %8d %8.3f%s\n", suite[w].name, schedulerNames[s], r.cycles,
+               r.avgTurnaround, r.avgWaiting, r.avgResponse, 100 * r.cpuUtilization, r.contextSwitches, r.fairness,
+               r.completed ? "" : "  (incomplete)");
+      if (!r.completed)
+        status = 1;
+      failures += checkThresholds(rules, ruleCount, suite[w].name, schedulerNames[s], &r);
+    }
+    removeWorkload(&suite[w], outDir != NULL);
+  }
+
+  // The disk policies only differ once requests queue up on tracks far apart
+  QualityWorkload disk = {"disk", {{PROG_DISK, MEMORY_SIZE / 3, 0}, {PROG_DISK, MEMORY_SIZE / 3, 0},
+                                   {PROG_DISK, MEMORY_SIZE / 3, 1}}, 3, true};
+  Workload workload;
+  if (status == 0 && writeWorkload(&disk, &workload))
+  {
+    if (csv)
+      printf("\nworkload,policy,completed,cycles,requests,seek,diskwait\n");
+    else
+      printf("\n%-8s %-6s %7s %8s %8s %8s\n", "Workload", "Disk", "Cycles", "Requests", "Seek", "DiskWait");
+    for (int p = 0; p < QUALITY_DISK_POLICIES; p++)
+    {
+      SchedulerConfig cfg;
+      defaultSchedulerConfig(&cfg, SIM_SCHED_RR, rrQuantum);
+      workload.diskPolicy = (DiskPolicy)p;
+      RunResult r;
+      runWorkload(&workload, &cfg, maxCycles, &r);
+      if (csv)
+        printf("%s,%s,%d,%d,%ld,%.3f,%.3f\n", disk.name, diskPolicyNames[p], r.completed, r.cycles, r.diskRequests,
+               metricValue(&r, "seek"), metricValue(&r, "diskwait"));
+      else
+        printf("%-8s %-6s %7d %8ld %8.2f %8.2f%s\n", disk.name, diskPolicyNames[p], r.cycles, r.diskRequests,
+               metricValue(&r, "seek"), metricValue(&r, "diskwait"), r.completed ? "" : "  (incomplete)");
+      if (!r.completed)
+        status = 1;
+      failures += checkThresholds(rules, ruleCount, disk.name, diskPolicyNames[p], &r);
+    }
+    removeWorkload(&disk, outDir != NULL);
+  }
+  else
+    status = 1;
+
+  if (chdir(cwd) != 0 || (!outDir && rmdir(scratch) != 0))
+    fprintf(stderr, "Warning: could not clean up %s\n", root);
+  if (thresholdsPath)
+    fprintf(stderr, "%d threshold rule(s) failed\n", failures);
+  return status || failures ? 1 : 0;
+}
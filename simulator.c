@@ -1,40 +1,180 @@
 #include "simulator.h"
 #include <stdarg.h> // For va_list, vsnprintf
+#include <limits.h> // For INT_MAX
+#include <sys/stat.h> // For mkdir
 
-// Helper function for logging via callback
-static void sim_log(SystemState *sys, const char *format, ...)
+#if MAX_PROCESSES > 32767
+#error "SimEvent.pid is a short; MAX_PROCESSES must stay below 32768"
+#endif
+
+static void eventLogAppend(EventLog *log, const SimEvent *e, const char *text);
+static int formatEventText(const SimEvent *e, const char *text, char *buf, size_t size);
+
+// Category and level of each event kind, checked by sim_event before anything is recorded
+static const struct
+{
+  unsigned char category, level;
+} eventFilter[SIM_EV_KIND_COUNT] = {
+    [SIM_EV_TEXT]            = {SIM_LOG_SCHED, SIM_LOG_INFO},
+    [SIM_EV_CYCLE]           = {SIM_LOG_SCHED, SIM_LOG_DEBUG},
+    [SIM_EV_ARRIVAL]         = {SIM_LOG_SCHED, SIM_LOG_INFO},
+    [SIM_EV_DISPATCH]        = {SIM_LOG_SCHED, SIM_LOG_INFO},
+    [SIM_EV_IDLE]            = {SIM_LOG_SCHED, SIM_LOG_INFO},
+    [SIM_EV_RR_EXPIRED]      = {SIM_LOG_SCHED, SIM_LOG_INFO},
+    [SIM_EV_MLFQ_EXPIRED]    = {SIM_LOG_SCHED, SIM_LOG_INFO},
+    [SIM_EV_DEMOTED]         = {SIM_LOG_SCHED, SIM_LOG_INFO},
+    [SIM_EV_EXECUTE]         = {SIM_LOG_INTERP, SIM_LOG_DEBUG},
+    [SIM_EV_PROGRAM_END]     = {SIM_LOG_INTERP, SIM_LOG_INFO},
+    [SIM_EV_TERMINATED]      = {SIM_LOG_INTERP, SIM_LOG_INFO},
+    [SIM_EV_LOCK_WAIT]       = {SIM_LOG_SYNC, SIM_LOG_INFO},
+    [SIM_EV_ACQUIRED]        = {SIM_LOG_SYNC, SIM_LOG_INFO},
+    [SIM_EV_RELEASED]        = {SIM_LOG_SYNC, SIM_LOG_INFO},
+    [SIM_EV_BLOCKED]         = {SIM_LOG_SYNC, SIM_LOG_INFO},
+    [SIM_EV_UNBLOCKED]       = {SIM_LOG_SYNC, SIM_LOG_INFO},
+    [SIM_EV_BURST]           = {SIM_LOG_INTERP, SIM_LOG_DEBUG},
+    [SIM_EV_BURST_END]       = {SIM_LOG_INTERP, SIM_LOG_INFO},
+    [SIM_EV_COMPLETE]        = {SIM_LOG_SCHED, SIM_LOG_INFO},
+    [SIM_EV_LOADED]          = {SIM_LOG_MEMORY, SIM_LOG_INFO},
+    [SIM_EV_INPUT_WAIT]      = {SIM_LOG_IO, SIM_LOG_INFO},
+    [SIM_EV_INPUT_DONE]      = {SIM_LOG_IO, SIM_LOG_INFO},
+    [SIM_EV_DISK_WAIT]       = {SIM_LOG_IO, SIM_LOG_INFO},
+    [SIM_EV_DISK_DONE]       = {SIM_LOG_IO, SIM_LOG_INFO},
+};
+
+// Emission-site filters: a message whose category is set below its level costs one
+// comparison, with no argument formatting and no call.
+#define sim_log(sys, category, level, ...)            \
+  do                                                  \
+  {                                                   \
+    if ((level) <= (sys)->logLevel[(category)])       \
+      sim_log_emit((sys), __VA_ARGS__);               \
+  } while (0)
+#define sim_event_enabled(sys, kind) (eventFilter[(kind)].level <= (sys)->logLevel[eventFilter[(kind)].category])
+#define sim_event(sys, kind, ...)                 \
+  do                                              \
+  {                                               \
+    if (sim_event_enabled((sys), (kind)))         \
+      sim_event_emit((sys), (kind), __VA_ARGS__); \
+  } while (0)
+
+// Host profiling: phase switches charge the elapsed time to the phase being left
+#ifdef MINISIM_HOST_PROFILE
+#include <time.h>
+
+static unsigned long long hostNow(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+// Makes `next` the phase being timed (-1: none) and returns the previous one; resuming a
+// phase after a callback does not count as another call
+static int hostSwitch(SystemState *sys, int next, bool enter)
+{
+  HostProfile *hp = &sys->hostProfile;
+  unsigned long long now = hostNow();
+  if (hp->current >= 0)
+    hp->phase[hp->current].ns += now - hp->mark;
+  if (next >= 0 && enter)
+    hp->phase[next].count++;
+  int previous = hp->current;
+  hp->current = next;
+  hp->mark = now;
+  return previous;
+}
+
+static void hostCharge(HostTimer *t, unsigned long long since)
+{
+  t->ns += hostNow() - since;
+  t->count++;
+}
+
+#define HOST_PHASE(sys, p) hostSwitch((sys), (p), true)
+#define HOST_CALLBACK_BEGIN(sys) int hostPrevious_ = hostSwitch((sys), SIM_PHASE_CALLBACKS, true)
+#define HOST_CALLBACK_END(sys) hostSwitch((sys), hostPrevious_, false)
+#define HOST_TIMER_BEGIN(name) unsigned long long name = hostNow()
+#define HOST_TIMER_END(timer, name) hostCharge(&(timer), (name))
+#else
+#define HOST_PHASE(sys, p) ((void)0)
+#define HOST_CALLBACK_BEGIN(sys) ((void)0)
+#define HOST_CALLBACK_END(sys) ((void)0)
+#define HOST_TIMER_BEGIN(name) ((void)0)
+#define HOST_TIMER_END(timer, name) ((void)sizeof(timer))
+#endif
+
+// Helper function for logging via callback (use sim_log, which filters first)
+static void sim_log_emit(SystemState *sys, const char *format, ...)
 {
-  if (sys->callbacks && sys->callbacks->log_message)
+  if (sys->callbacks && !sys->callbacks->log_message && !sys->eventLog)
   {
-    char buffer[256];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(buffer, sizeof(buffer), format, args);
-    va_end(args);
-    sys->callbacks->log_message(sys->gui_data, buffer);
+    return; // Callbacks registered without a logger: discard without formatting
+  }
+  HOST_CALLBACK_BEGIN(sys);
+  char buffer[256];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (sys->eventLog)
+  {
+    SimEvent e = {sys->clockCycle, SIM_EV_TEXT, -1, 0, 0, 0, 0, -1};
+    eventLogAppend(sys->eventLog, &e, buffer);
+  }
+  if (sys->callbacks)
+  {
+    if (sys->callbacks->log_message)
+      sys->callbacks->log_message(sys->gui_data, buffer);
   }
   else
   {
-    // Fallback to stdout if no callback is registered
-    va_list args;
-    va_start(args, format);
-    vprintf(format, args);
-    printf("\n"); // Add newline for clarity
-    va_end(args);
+    printf("%s\n", buffer); // Fallback to stdout if no callback is registered
   }
+  HOST_CALLBACK_END(sys);
+}
+
+// Records a typed event for the hot paths: appended to the event log without formatting,
+// and formatted immediately only for a registered logger (or the stdout fallback).
+// text, if not NULL, is copied.
+static void sim_event_emit(SystemState *sys, SimEventKind kind, int pid, int a, int b, int c, int d,
+                           const char *text)
+{
+  if (sys->callbacks && !sys->callbacks->log_message && !sys->eventLog)
+  {
+    return;
+  }
+  HOST_CALLBACK_BEGIN(sys);
+  SimEvent e = {sys->clockCycle, (unsigned short)kind, (short)pid, a, b, c, d, -1};
+  if (sys->eventLog)
+  {
+    eventLogAppend(sys->eventLog, &e, text);
+  }
+  if (!sys->callbacks || sys->callbacks->log_message)
+  {
+    char buffer[256];
+    formatEventText(&e, text, buffer, sizeof(buffer));
+    if (sys->callbacks)
+      sys->callbacks->log_message(sys->gui_data, buffer);
+    else
+      printf("%s\n", buffer);
+  }
+  HOST_CALLBACK_END(sys);
 }
 
 // Helper function for process output via callback
 static void sim_output(SystemState *sys, int pid, const char *output)
 {
-  if (sys->callbacks && sys->callbacks->process_output)
+  HOST_CALLBACK_BEGIN(sys);
+  if (sys->callbacks)
   {
-    sys->callbacks->process_output(sys->gui_data, pid, output);
+    if (sys->callbacks->process_output)
+      sys->callbacks->process_output(sys->gui_data, pid, output);
   }
   else
   {
     printf("P%d OUTPUT: %s\n", pid, output); // Fallback
   }
+  HOST_CALLBACK_END(sys);
 }
 
 // Helper function to notify GUI of state change
@@ -42,13 +182,17 @@ static void notify_state_update(SystemState *sys)
 {
   if (sys->callbacks && sys->callbacks->state_update)
   {
+    HOST_CALLBACK_BEGIN(sys);
     sys->callbacks->state_update(sys->gui_data, sys);
+    HOST_CALLBACK_END(sys);
   }
 }
 
 // --- Internal Function Declarations ---
 // (These are now static as they are internal to simulator.c)
 static void checkArrivals(SystemState *sys);
+static void logMetricsSummary(SystemState *sys);
+static LineProfile *lineProfileAt(SystemState *sys, const PCB *pcb);
 static void addToReadyQueue(SystemState *sys, int pid);
 static int scheduleNextProcess(SystemState *sys); // Combined scheduler logic
 static void interpretInstruction(SystemState *sys, int pid);
@@ -62,30 +206,54 @@ static void blockProcess(SystemState *sys, int pid, ResourceType r);
 static void unblockProcess(SystemState *sys, ResourceType r);
 static void do_print(SystemState *sys, int pid, char *arg1);
 static void do_assign(SystemState *sys, int pid, char *varName, char *valueOrInput);
+static void syncPendingInput(SystemState *sys);
+static void finishBlockedInstruction(SystemState *sys, PCB *pcb, SimEventKind done, int c);
+static bool diskEnabled(const SystemState *sys);
+static void diskSubmit(SystemState *sys, PCB *pcb);
+static void diskTick(SystemState *sys);
 static void do_writeFile(SystemState *sys, int pid, char *fileVar, char *dataVar);
 static void do_readFile(SystemState *sys, int pid, char *fileVar);
 static void do_printFromTo(SystemState *sys, int pid, char *v1, char *v2);
 static void do_semWait(SystemState *sys, int pid, char *resName);
 static void do_semSignal(SystemState *sys, int pid, char *resName);
+static bool acquireResource(SystemState *sys, int pid, ResourceType r);
+static bool releaseResource(SystemState *sys, int pid, ResourceType r);
+static void releaseHeldLocks(SystemState *sys, int pid);
+static void executeBurstCycle(SystemState *sys, int pid);
 static void addToMLFQ(SystemState *sys, int pid, int level);
+static void fsInit(SimFs *fs);
 static int getProgramNumberFromFilename(const char *filename);
 
 // ---------------- Implementation ----------------
 
+#define MINISIM_STR2(x) #x
+#define MINISIM_STR(x) MINISIM_STR2(x)
+
+const char *minisimVersion(void)
+{
+  return MINISIM_STR(MINISIM_VERSION_MAJOR) "." MINISIM_STR(MINISIM_VERSION_MINOR) "." MINISIM_STR(MINISIM_VERSION_PATCH);
+}
+
 void initializeSystem(SystemState *sys, SchedulerType type, int rrQuantumVal, GuiCallbacks *callbacks, void *gui_data)
 {
   memset(sys, 0, sizeof(SystemState)); // This will initialize wasUnblockedThisCycle to false
+  sys->hostProfile.current = -1;
+  fsInit(&sys->fs);
+  sys->disk.direction = 1;
 
   sys->memoryPointer = 0;
   sys->processCount = 0;
   sys->runningProcessID = -1;
+  sys->lastDispatchedPid = -1;
   sys->clockCycle = 0;
   sys->needsInput = false;
+  sys->inputPid = -1;
   sys->simulationComplete = false;
 
   sys->schedulerType = type;
   sys->rrQuantum = (type == SIM_SCHED_RR) ? (rrQuantumVal > 0 ? rrQuantumVal : 1) : 0;
   // Default MLFQ quanta
+  sys->mlfqLevels = MLFQ_LEVELS;
   sys->mlfqQuantum[0] = 1;
   sys->mlfqQuantum[1] = 2;
   sys->mlfqQuantum[2] = 4;
@@ -93,6 +261,7 @@ void initializeSystem(SystemState *sys, SchedulerType type, int rrQuantumVal, Gu
 
   sys->callbacks = callbacks;
   sys->gui_data = gui_data;
+  setLogLevel(sys, SIM_LOG_ALL, SIM_LOG_DEBUG);
 
   // Clear memory (already done by memset, but explicit doesn't hurt)
   for (int i = 0; i < MEMORY_SIZE; i++)
@@ -114,39 +283,96 @@ void initializeSystem(SystemState *sys, SchedulerType type, int rrQuantumVal, Gu
     sys->mutexes[i].lockingProcessID = -1;
     sys->mutexes[i].head = sys->mutexes[i].tail = sys->mutexes[i].size = 0;
   }
-  sim_log(sys, "System initialized (%s, RRQ=%d)",
+  sim_log(sys, SIM_LOG_SCHED, SIM_LOG_INFO, "System initialized (%s, RRQ=%d)",
           type == SIM_SCHED_FCFS ? "FCFS" : type == SIM_SCHED_RR ? "RR"
                                                                  : "MLFQ",
           sys->rrQuantum);
   notify_state_update(sys);
 }
 
+// Overrides the MLFQ level count and per-level quanta (quanta may be NULL to keep the defaults)
+void setMLFQConfig(SystemState *sys, int levels, const int *quanta)
+{
+  if (levels < 1)
+    levels = 1;
+  if (levels > MLFQ_LEVELS)
+    levels = MLFQ_LEVELS;
+  sys->mlfqLevels = levels;
+  if (quanta)
+  {
+    for (int l = 0; l < levels; l++)
+    {
+      sys->mlfqQuantum[l] = quanta[l] > 0 ? quanta[l] : 1;
+    }
+  }
+}
+
+typedef enum
+{
+  LOAD_OK,
+  LOAD_NO_MEMORY, // Would fit once resident processes release memory
+  LOAD_FAILED
+} LoadStatus;
+
+// First fit over the gaps between resident segments (slots whose memory was
+// released by vacateTerminatedSlot have memoryLowerBound -1). Returns -1 if no gap is large enough.
 static int allocateMemory(SystemState *sys, int words)
 {
-  if (sys->memoryPointer + words > MEMORY_SIZE)
-  {
-    sim_log(sys, "Error: Out of memory! Requested %d words, available %d.",
-            words, MEMORY_SIZE - sys->memoryPointer);
-    return -1;
+  int start = 0;
+  bool moved = true;
+  while (moved)
+  {
+    if (start + words > MEMORY_SIZE)
+      return -1;
+    moved = false;
+    for (int i = 0; i < sys->processCount; i++)
+    {
+      PCB *pcb = &sys->processTable[i];
+      if (pcb->memoryLowerBound >= 0 && pcb->memoryLowerBound < start + words && pcb->memoryUpperBound >= start)
+      {
+        start = pcb->memoryUpperBound + 1;
+        moved = true;
+      }
+    }
   }
-  int start = sys->memoryPointer;
-  sys->memoryPointer += words;
+  if (start + words > sys->memoryPointer)
+    sys->memoryPointer = start + words; // High-water mark
   return start;
 }
 
+static LoadStatus loadProgramIntoSlot(SystemState *sys, const char *filename, int arrivalTime, int slot);
+
 // Returns true on success, false on failure
 bool loadProgram(SystemState *sys, const char *filename)
+{
+  return loadProgramAt(sys, filename, sys->clockCycle);
+}
+
+// Same as loadProgram, but the process stays NEW until the given clock cycle
+bool loadProgramAt(SystemState *sys, const char *filename, int arrivalTime)
 {
   if (sys->processCount >= MAX_PROCESSES)
   {
-    sim_log(sys, "Error: process table full, cannot load %s", filename);
+    sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error: process table full, cannot load %s", filename);
     return false;
   }
+  LoadStatus status = loadProgramIntoSlot(sys, filename, arrivalTime < sys->clockCycle ? sys->clockCycle : arrivalTime,
+                                          sys->processCount);
+  if (status == LOAD_NO_MEMORY)
+  {
+    sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error: Out of memory! Cannot load %s.", filename);
+  }
+  return status == LOAD_OK;
+}
+
+// Loads a program into processTable[slot], which is either the next unused slot or a vacated one
+static LoadStatus loadProgramIntoSlot(SystemState *sys, const char *filename, int arrivalTime, int slot)
+{
   FILE *f = fopen(filename, "r");
   if (!f)
   {
-    sim_log(sys, "Error opening program file '%s': %s", filename, strerror(errno));
-    return false;
+    sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error opening program file '%s': %s", filename, strerror(errno));
+    return LOAD_FAILED;
   }
 
   // Count non-empty lines
@@ -172,13 +398,13 @@ bool loadProgram(SystemState *sys, const char *filename)
 
   if (count == 0)
   {
-    sim_log(sys, "Warning: %s is empty or contains only whitespace.", filename);
+    sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_WARN, "Warning: %s is empty or contains only whitespace.", filename);
     fclose(f);
-    return true; // Not a failure, just nothing to load
+    return LOAD_OK; // Not a failure, just nothing to load
   }
   if (count > MAX_PROGRAM_LINES)
   {
-    sim_log(sys, "Warning: %s has %d lines, truncated to %d.", filename, count, MAX_PROGRAM_LINES);
+    sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_WARN, "Warning: %s has %d lines, truncated to %d.", filename, count, MAX_PROGRAM_LINES);
     count = MAX_PROGRAM_LINES;
   }
   rewind(f);
@@ -186,26 +412,38 @@ bool loadProgram(SystemState *sys, const char *filename)
   // Memory needed: Instructions + Variables + PCB placeholder (optional, not strictly needed if PCB is separate)
   // Let's stick to the original calculation for consistency for now.
   int memNeeded = count + NUM_VARIABLES + PCB_SIZE;
+  if (memNeeded > MEMORY_SIZE)
+  {
+    sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error: %s needs %d memory words, more than the %d available.", filename, memNeeded, MEMORY_SIZE);
+    fclose(f);
+    return LOAD_FAILED;
+  }
   int lb = allocateMemory(sys, memNeeded);
   if (lb < 0)
   {
     fclose(f);
-    return false; // Allocation failed
+    return LOAD_NO_MEMORY;
   }
   int ub = lb + memNeeded - 1; // Inclusive upper bound
 
-  PCB *pcb = &sys->processTable[sys->processCount];
-  pcb->processID = sys->processCount;
+  PCB *pcb = &sys->processTable[slot];
+  memset(pcb, 0, sizeof(*pcb));
+  pcb->processID = slot;
   pcb->programNumber = getProgramNumberFromFilename(filename);
   pcb->state = NEW;
   pcb->priority = 0; // Default priority, MLFQ will adjust
   pcb->programCounter = 0;
   pcb->memoryLowerBound = lb;
   pcb->memoryUpperBound = ub;
-  pcb->arrivalTime = sys->clockCycle;
+  pcb->arrivalTime = arrivalTime;
   pcb->blockedOnResource = (ResourceType)-1; // Use -1 to indicate not blocked
   pcb->quantumRemaining = 0;
   pcb->mlfqLevel = 0; // Start at highest level
+  pcb->firstRunTime = -1;
+  pcb->completionTime = -1;
+  pcb->cpuCycles = 0;
+  pcb->waitingTime = 0;
+  pcb->readySince = pcb->arrivalTime;
 
   // Load instructions into memory
   int currentMemIdx = lb;
@@ -238,10 +476,10 @@ bool loadProgram(SystemState *sys, const char *filename)
     }
     else
     {
-      sim_log(sys, "Error: Memory overflow while loading instructions for P%d", pcb->processID);
+      sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error: Memory overflow while loading instructions for P%d", pcb->processID);
       fclose(f);
       // Should ideally free allocated memory here, but let's keep it simple
-      return false;
+      return LOAD_FAILED;
     }
   }
   fclose(f);
@@ -270,11 +508,19 @@ bool loadProgram(SystemState *sys, const char *filename)
     }
   }
 
-  sim_log(sys, "Loaded P%d: lines=%d, mem=[%d..%d], arrival=%d",
-          pcb->programNumber, linesRead, lb, ub, sys->clockCycle);
-  sys->processCount++;
+  if (sim_event_enabled(sys, SIM_EV_LOADED))
+  {
+    char message[128];
+    snprintf(message, sizeof(message), "Loaded P%d: lines=%d, mem=[%d..%d], arrival=%d", pcb->programNumber,
+             linesRead, lb, ub, pcb->arrivalTime);
+    sim_event_emit(sys, SIM_EV_LOADED, slot, pcb->programNumber, pcb->arrivalTime, 0, 0, message);
+  }
+  if (slot == sys->processCount)
+  {
+    sys->processCount++;
+  }
   notify_state_update(sys); // Notify GUI about the new process
-  return true;
+  return LOAD_OK;
 }
 
 PCB *findPCB(SystemState *sys, int pid)
@@ -312,6 +558,583 @@ int findInstructionCount(SystemState *sys, int pid)
   return count;
 }
 
+// ------------- Log Filtering -------------
+
+static const char *const logCategoryNames[SIM_LOG_CATEGORY_COUNT] = {"sched", "interp", "memory", "sync", "io"};
+static const char *const logLevelNames[] = {"off", "error", "warn", "info", "debug"};
+
+void setLogLevel(SystemState *sys, SimLogCategory category, SimLogLevel level)
+{
+  if (level < SIM_LOG_OFF || level > SIM_LOG_DEBUG)
+    return;
+  for (int c = 0; c < SIM_LOG_CATEGORY_COUNT; c++)
+  {
+    if (category == SIM_LOG_ALL || category == (SimLogCategory)c)
+      sys->logLevel[c] = (unsigned char)level;
+  }
+}
+
+// Returns the index of the name of length len in names, or -1
+static int lookupLogName(const char *const *names, int count, const char *name, size_t len)
+{
+  for (int i = 0; i < count; i++)
+  {
+    if (strlen(names[i]) == len && strncmp(names[i], name, len) == 0)
+      return i;
+  }
+  return -1;
+}
+
+bool parseLogLevels(SystemState *sys, const char *spec)
+{
+  unsigned char levels[SIM_LOG_CATEGORY_COUNT];
+  memcpy(levels, sys->logLevel, sizeof(levels));
+  const char *p = spec;
+  while (*p)
+  {
+    size_t len = strcspn(p, ",");
+    const char *eq = memchr(p, '=', len);
+    int category = SIM_LOG_ALL;
+    const char *levelName = p;
+    if (eq)
+    {
+      size_t nameLen = (size_t)(eq - p);
+      if (!(nameLen == 3 && strncmp(p, "all", 3) == 0))
+      {
+        category = lookupLogName(logCategoryNames, SIM_LOG_CATEGORY_COUNT, p, nameLen);
+        if (category < 0)
+          break;
+      }
+      levelName = eq + 1;
+    }
+    int level = lookupLogName(logLevelNames, SIM_LOG_DEBUG + 1, levelName, (size_t)(p + len - levelName));
+    if (level < 0)
+      break;
+    setLogLevel(sys, (SimLogCategory)category, (SimLogLevel)level);
+    p += len;
+    if (*p == ',')
+      p++;
+  }
+  if (*p)
+  {
+    memcpy(sys->logLevel, levels, sizeof(levels)); // Nothing applied from an invalid spec
+    return false;
+  }
+  return true;
+}
+
+// ------------- Event Log -------------
+
+void eventLogInit(EventLog *log)
+{
+  memset(log, 0, sizeof(*log));
+}
+
+void eventLogClear(EventLog *log)
+{
+  log->count = 0;
+  log->textUsed = 0;
+}
+
+void eventLogFree(EventLog *log)
+{
+  free(log->events);
+  free(log->text);
+  eventLogInit(log);
+}
+
+void setEventLog(SystemState *sys, EventLog *log)
+{
+  sys->eventLog = log;
+}
+
+// Appends a copy of e (and of text, if any); on allocation failure the event is counted as dropped
+static void eventLogAppend(EventLog *log, const SimEvent *e, const char *text)
+{
+  if (log->count == log->capacity)
+  {
+    size_t capacity = log->capacity ? log->capacity * 2 : 1024;
+    SimEvent *events = realloc(log->events, capacity * sizeof(SimEvent));
+    if (!events)
+    {
+      log->dropped++;
+      return;
+    }
+    log->events = events;
+    log->capacity = capacity;
+  }
+  SimEvent *slot = &log->events[log->count];
+  *slot = *e;
+  slot->text = -1;
+  if (text)
+  {
+    size_t len = strlen(text) + 1;
+    if (log->textUsed + len > log->textCapacity)
+    {
+      size_t capacity = log->textCapacity ? log->textCapacity : 4096;
+      while (capacity < log->textUsed + len)
+        capacity *= 2;
+      char *grown = capacity <= INT_MAX ? realloc(log->text, capacity) : NULL;
+      if (!grown)
+      {
+        log->dropped++;
+        return;
+      }
+      log->text = grown;
+      log->textCapacity = capacity;
+    }
+    memcpy(log->text + log->textUsed, text, len);
+    slot->text = (int)log->textUsed;
+    log->textUsed += len;
+  }
+  log->count++;
+}
+
+// The text each kind stands for; matches what the engine logged before events were typed
+static int formatEventText(const SimEvent *e, const char *text, char *buf, size_t size)
+{
+  if (!text)
+    text = "";
+  switch ((SimEventKind)e->kind)
+  {
+  case SIM_EV_TEXT:
+  case SIM_EV_LOADED:
+    return snprintf(buf, size, "%s", text);
+  case SIM_EV_CYCLE:
+    return snprintf(buf, size, "--- Clock Cycle %d ---", e->cycle);
+  case SIM_EV_ARRIVAL:
+    return snprintf(buf, size, "Clock %d: P%d arrived.", e->cycle, e->a);
+  case SIM_EV_DISPATCH:
+    return snprintf(buf, size, "Scheduler: Dispatching P%d (Level: %d, Quantum: %d)", e->a, e->b, e->c);
+  case SIM_EV_IDLE:
+    return snprintf(buf, size, "Scheduler: CPU Idle - No ready processes.");
+  case SIM_EV_RR_EXPIRED:
+    return snprintf(buf, size, "P%d RR quantum expired.", e->a);
+  case SIM_EV_MLFQ_EXPIRED:
+    return snprintf(buf, size, "P%d MLFQ quantum expired at level %d.", e->a, e->b);
+  case SIM_EV_DEMOTED:
+    return snprintf(buf, size, "P%d demoted to level %d.", e->a, e->b);
+  case SIM_EV_EXECUTE:
+    return snprintf(buf, size, "P%d Executing [PC=%d]: %s", e->a, e->b, text);
+  case SIM_EV_PROGRAM_END:
+    return snprintf(buf, size, "P%d finished program after instruction (PC=%d, InstCount=%d). Terminating.", e->a,
+                    e->b, e->c);
+  case SIM_EV_TERMINATED:
+    return snprintf(buf, size, "P%d terminated during execution.", e->a);
+  case SIM_EV_LOCK_WAIT:
+    return snprintf(buf, size, "P%d requests locked resource %d. Blocking.", e->a, e->b);
+  case SIM_EV_ACQUIRED:
+    return snprintf(buf, size, "P%d acquired resource %d.", e->a, e->b);
+  case SIM_EV_RELEASED:
+    return snprintf(buf, size, "P%d released resource %d.", e->a, e->b);
+  case SIM_EV_BLOCKED:
+    return snprintf(buf, size, "P%d BLOCKED on resource %d", e->a, e->b);
+  case SIM_EV_UNBLOCKED:
+    return snprintf(buf, size, "P%d UNBLOCKED from resource %d, added to ready queue.", e->a, e->b);
+  case SIM_EV_BURST:
+    return snprintf(buf, size, "P%d Burst [%d/%d]: %d cycle(s) left", e->a, e->b, e->c, e->d);
+  case SIM_EV_BURST_END:
+    return snprintf(buf, size, "P%d finished its last burst. Terminating.", e->a);
+  case SIM_EV_COMPLETE:
+    return snprintf(buf, size, "Simulation Complete at Clock Cycle %d.", e->cycle);
+  case SIM_EV_INPUT_WAIT:
+    return snprintf(buf, size, "P%d BLOCKED waiting for input for variable '%s'", e->a, text ? text : "?");
+  case SIM_EV_INPUT_DONE:
+    return snprintf(buf, size, e->b ? "P%d got its input; program finished." : "P%d got its input, added to ready queue.",
+                    e->a);
+  case SIM_EV_DISK_WAIT:
+    return snprintf(buf, size, "P%d BLOCKED on disk: %d block(s), first at track %d", e->a, e->c, e->b);
+  case SIM_EV_DISK_DONE:
+    return snprintf(buf, size,
+                    e->b ? "P%d disk request done after %d cycle(s); program finished."
+                         : "P%d disk request done after %d cycle(s), added to ready queue.",
+                    e->a, e->c);
+  default:
+    return snprintf(buf, size, "Unknown event %d", (int)e->kind);
+  }
+}
+
+int formatSimEvent(const EventLog *log, const SimEvent *e, char *buf, size_t size)
+{
+  const char *text = (e->text >= 0 && log && (size_t)e->text < log->textUsed) ? log->text + e->text : NULL;
+  return formatEventText(e, text, buf, size);
+}
+
+// ------------- Input Script -------------
+
+void inputScriptInit(InputScript *script)
+{
+  memset(script, 0, sizeof(*script));
+}
+
+bool inputScriptAdd(InputScript *script, int program, const char *var, const char *value)
+{
+  if (script->count == script->capacity)
+  {
+    size_t capacity = script->capacity ? script->capacity * 2 : 64;
+    InputScriptEntry *entries = realloc(script->entries, capacity * sizeof(InputScriptEntry));
+    if (!entries)
+      return false;
+    script->entries = entries;
+    script->capacity = capacity;
+  }
+  InputScriptEntry *e = &script->entries[script->count++];
+  e->program = program;
+  snprintf(e->var, sizeof(e->var), "%s", var);
+  snprintf(e->value, sizeof(e->value), "%s", value);
+  e->used = false;
+  return true;
+}
+
+int inputScriptLoad(InputScript *script, const char *path)
+{
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return -1;
+  char line[256];
+  int lineNumber = 0;
+  while (fgets(line, sizeof(line), f))
+  {
+    lineNumber++;
+    line[strcspn(line, "#\r\n")] = '\0';
+    if (strspn(line, " \t") == strlen(line))
+      continue; // Blank or comment only
+    char program[32], var[50];
+    int valueAt = 0;
+    bool ok = sscanf(line, " %31s %49s %n", program, var, &valueAt) == 2;
+    int number = -1;
+    if (ok && strcmp(program, "*") != 0)
+    {
+      const char *digits = program + (program[0] == 'P' || program[0] == 'p');
+      char *end;
+      number = (int)strtol(digits, &end, 10);
+      ok = end != digits && *end == '\0' && number >= 0;
+    }
+    if (!ok || !inputScriptAdd(script, number, var, line + valueAt))
+    {
+      fclose(f);
+      return lineNumber;
+    }
+  }
+  fclose(f);
+  return 0;
+}
+
+void inputScriptRewind(InputScript *script)
+{
+  for (size_t i = 0; i < script->count; i++)
+    script->entries[i].used = false;
+  if (script->cursors)
+    memset(script->cursors, 0, script->cursorCapacity * sizeof(InputScriptCursor));
+  script->cursorCount = 0;
+}
+
+void inputScriptFree(InputScript *script)
+{
+  free(script->entries);
+  free(script->cursors);
+  inputScriptInit(script);
+}
+
+static size_t inputCursorHash(int program, const char *var)
+{
+  size_t h = 2166136261u ^ (size_t)(unsigned)program; // FNV-1a
+  for (; *var; var++)
+    h = (h ^ (unsigned char)*var) * 16777619u;
+  return h;
+}
+
+// The cursor of a request key, added at the start of the script if new; NULL if out of host memory
+static size_t *inputScriptCursor(InputScript *script, int program, const char *var)
+{
+  if (2 * (script->cursorCount + 1) > script->cursorCapacity)
+  {
+    size_t capacity = script->cursorCapacity ? script->cursorCapacity * 2 : 64;
+    InputScriptCursor *cursors = calloc(capacity, sizeof(InputScriptCursor));
+    if (!cursors)
+      return NULL;
+    for (size_t i = 0; i < script->cursorCapacity; i++)
+    {
+      const InputScriptCursor *c = &script->cursors[i];
+      if (!c->taken)
+        continue;
+      size_t j = inputCursorHash(c->program, c->var) & (capacity - 1);
+      while (cursors[j].taken)
+        j = (j + 1) & (capacity - 1);
+      cursors[j] = *c;
+    }
+    free(script->cursors);
+    script->cursors = cursors;
+    script->cursorCapacity = capacity;
+  }
+  size_t mask = script->cursorCapacity - 1;
+  for (size_t i = inputCursorHash(program, var) & mask;; i = (i + 1) & mask)
+  {
+    InputScriptCursor *c = &script->cursors[i];
+    if (!c->taken)
+    {
+      c->taken = true;
+      c->program = program;
+      strncpy(c->var, var, sizeof(c->var) - 1);
+      c->var[sizeof(c->var) - 1] = '\0';
+      c->next = 0;
+      script->cursorCount++;
+      return &c->next;
+    }
+    if (c->program == program && strncmp(c->var, var, sizeof(c->var) - 1) == 0)
+      return &c->next;
+  }
+}
+
+void setInputScript(SystemState *sys, InputScript *script)
+{
+  sys->inputScript = script;
+}
+
+// Next unused scripted value for the request, or NULL
+static const char *takeScriptedInput(SystemState *sys, const PCB *pcb, const char *var)
+{
+  InputScript *script = sys->inputScript;
+  if (!script)
+    return NULL;
+  size_t *cursor = inputScriptCursor(script, pcb->programNumber, var);
+  for (size_t i = cursor ? *cursor : 0; i < script->count; i++)
+  {
+    InputScriptEntry *e = &script->entries[i];
+    if (!e->used && (e->program < 0 || e->program == pcb->programNumber) &&
+        (strcmp(e->var, "*") == 0 || strcmp(e->var, var) == 0))
+    {
+      e->used = true;
+      if (cursor)
+        *cursor = i + 1;
+      return e->value;
+    }
+  }
+  if (cursor)
+    *cursor = script->count; // Entries added later are scanned from here
+  return NULL;
+}
+
+// ------------- Trace Export -------------
+
+static const char *const traceStateNames[] = {"NEW", "READY", "RUNNING", "BLOCKED", "TERMINATED"};
+static const char *const traceResourceNames[NUM_RESOURCES] = {"file", "userInput", "userOutput"};
+
+#define TRACE_INPUT_DEVICE NUM_RESOURCES // TraceProcess.resource while blocked for input
+#define TRACE_DISK_DEVICE (NUM_RESOURCES + 1)
+
+// Track layout: processes are threads of pid 1; resource r is pid 2 + r
+#define TRACE_PROCESSES_PID 1
+#define TRACE_RESOURCE_PID(r) (2 + (r))
+
+static void traceSeparator(TraceWriter *w)
+{
+  fputs(w->first ? "\n" : ",\n", w->out);
+  w->first = false;
+}
+
+static void traceSlice(TraceWriter *w, const char *name, int pid, int tid, int from, int to)
+{
+  if (to <= from)
+    return;
+  traceSeparator(w);
+  fprintf(w->out, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%d,\"dur\":%d}", name, pid, tid, from,
+          to - from);
+}
+
+// Ends the slot's current state at cycle `at` and starts `state` (TERMINATED starts nothing)
+static void traceTransition(TraceWriter *w, int slot, int state, int at)
+{
+  TraceProcess *p = &w->proc[slot];
+  if (p->state >= NEW && p->state < TERMINATED)
+  {
+    char name[32];
+    if (p->state == BLOCKED && p->resource >= 0 && p->resource < NUM_RESOURCES)
+      snprintf(name, sizeof(name), "BLOCKED on %s", traceResourceNames[p->resource]);
+    else if (p->state == BLOCKED && p->resource == TRACE_INPUT_DEVICE)
+      snprintf(name, sizeof(name), "BLOCKED on input");
+    else if (p->state == BLOCKED && p->resource == TRACE_DISK_DEVICE)
+      snprintf(name, sizeof(name), "BLOCKED on disk");
+    else
+      snprintf(name, sizeof(name), "%s", traceStateNames[p->state]);
+    traceSlice(w, name, TRACE_PROCESSES_PID, p->track, p->since, at);
+  }
+  p->state = state;
+  p->since = at;
+}
+
+// Lock waits overlap, so they are async spans (one lane each) on the resource's track
+static void traceWait(TraceWriter *w, char phase, const TraceProcess *p, int resource, int at)
+{
+  traceSeparator(w);
+  fprintf(w->out, "{\"name\":\"P%d waits\",\"cat\":\"wait\",\"ph\":\"%c\",\"id\":%d,\"pid\":%d,\"tid\":0,\"ts\":%d}",
+          p->program, phase, p->track, TRACE_RESOURCE_PID(resource), at);
+}
+
+static void traceQueueLength(TraceWriter *w, int resource, int delta, int at)
+{
+  w->queued[resource] += delta;
+  traceSeparator(w);
+  fprintf(w->out, "{\"name\":\"blocked queue\",\"ph\":\"C\",\"pid\":%d,\"ts\":%d,\"args\":{\"length\":%d}}",
+          TRACE_RESOURCE_PID(resource), at, w->queued[resource]);
+}
+
+// Every load gets a fresh track, so runs of the same program never share one
+static void traceNameProcess(TraceWriter *w, int slot, int program)
+{
+  TraceProcess *p = &w->proc[slot];
+  p->program = program;
+  p->track = ++w->tracks;
+  traceSeparator(w);
+  fprintf(w->out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"P%d\"}}",
+          TRACE_PROCESSES_PID, p->track, program);
+}
+
+bool traceWriterOpen(TraceWriter *w, const char *path)
+{
+  memset(w, 0, sizeof(*w));
+  w->out = fopen(path, "w");
+  if (!w->out)
+    return false;
+  w->first = true;
+  for (int i = 0; i < MAX_PROCESSES; i++)
+    w->proc[i].state = -1;
+  fputs("{\"displayTimeUnit\":\"ms\",\"otherData\":{\"timeUnit\":\"1 us = 1 simulated clock cycle\"},"
+        "\"traceEvents\":[",
+        w->out);
+  traceSeparator(w);
+  fprintf(w->out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"Processes\"}}",
+          TRACE_PROCESSES_PID);
+  for (int r = 0; r < NUM_RESOURCES; r++)
+  {
+    w->holder[r] = -1;
+    traceSeparator(w);
+    fprintf(w->out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"Resource %s\"}}",
+            TRACE_RESOURCE_PID(r), traceResourceNames[r]);
+  }
+  return true;
+}
+
+void traceWriterAdd(TraceWriter *w, const EventLog *log)
+{
+  for (size_t i = 0; i < log->count; i++)
+  {
+    const SimEvent *e = &log->events[i];
+    int slot = e->pid;
+    if (slot < 0 || slot >= MAX_PROCESSES)
+      continue; // Not about a process (cycle start, idle, messages)
+    // Events raised while an instruction executes take effect when its cycle ends
+    int after = e->cycle + 1;
+    int r = e->b;
+    switch ((SimEventKind)e->kind)
+    {
+    case SIM_EV_LOADED:
+      traceTransition(w, slot, TERMINATED, e->cycle); // Slot recycled while its last state was open
+      traceNameProcess(w, slot, e->a);
+      w->proc[slot].state = NEW;
+      w->proc[slot].since = e->cycle;
+      break;
+    case SIM_EV_ARRIVAL:
+      if (w->proc[slot].state < 0 || w->proc[slot].program != e->a)
+        traceNameProcess(w, slot, e->a); // Loaded before the writer saw events
+      traceTransition(w, slot, READY, e->cycle);
+      break;
+    case SIM_EV_DISPATCH:
+      traceTransition(w, slot, RUNNING, e->cycle);
+      break;
+    case SIM_EV_RR_EXPIRED:
+    case SIM_EV_MLFQ_EXPIRED:
+      traceSeparator(w);
+      fprintf(w->out, "{\"name\":\"quantum expired\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%d",
+              TRACE_PROCESSES_PID, w->proc[slot].track, e->cycle);
+      if (e->kind == SIM_EV_MLFQ_EXPIRED)
+        fprintf(w->out, ",\"args\":{\"level\":%d}", e->b);
+      fputc('}', w->out);
+      traceTransition(w, slot, READY, e->cycle);
+      break;
+    case SIM_EV_BLOCKED:
+      traceTransition(w, slot, BLOCKED, after);
+      w->proc[slot].resource = r;
+      if (r >= 0 && r < NUM_RESOURCES)
+      {
+        traceWait(w, 'b', &w->proc[slot], r, after);
+        traceQueueLength(w, r, 1, after);
+      }
+      break;
+    case SIM_EV_UNBLOCKED:
+      traceTransition(w, slot, READY, after);
+      if (r >= 0 && r < NUM_RESOURCES)
+      {
+        traceWait(w, 'e', &w->proc[slot], r, after);
+        traceQueueLength(w, r, -1, after);
+      }
+      break;
+    case SIM_EV_INPUT_WAIT:
+      traceTransition(w, slot, BLOCKED, after);
+      w->proc[slot].resource = TRACE_INPUT_DEVICE;
+      break;
+    case SIM_EV_INPUT_DONE:
+      traceTransition(w, slot, e->b ? TERMINATED : READY, e->cycle); // Input arrives between cycles
+      break;
+    case SIM_EV_DISK_WAIT:
+      traceTransition(w, slot, BLOCKED, after);
+      w->proc[slot].resource = TRACE_DISK_DEVICE;
+      break;
+    case SIM_EV_DISK_DONE:
+      traceTransition(w, slot, e->b ? TERMINATED : READY, e->cycle); // Completes before the cycle's dispatch
+      break;
+    case SIM_EV_TERMINATED:
+      traceTransition(w, slot, TERMINATED, after);
+      break;
+    case SIM_EV_ACQUIRED:
+      if (r >= 0 && r < NUM_RESOURCES)
+      {
+        w->holder[r] = e->a;
+        w->holdSince[r] = after;
+      }
+      break;
+    case SIM_EV_RELEASED:
+      if (r >= 0 && r < NUM_RESOURCES && w->holder[r] == e->a)
+      {
+        char name[32];
+        snprintf(name, sizeof(name), "P%d holds", e->a);
+        traceSlice(w, name, TRACE_RESOURCE_PID(r), 0, w->holdSince[r], after);
+        w->holder[r] = -1;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+bool traceWriterClose(TraceWriter *w, int endCycle)
+{
+  if (!w->out)
+    return false;
+  for (int slot = 0; slot < MAX_PROCESSES; slot++)
+  {
+    TraceProcess *p = &w->proc[slot];
+    if (p->state == BLOCKED && p->resource >= 0 && p->resource < NUM_RESOURCES)
+      traceWait(w, 'e', p, p->resource, endCycle);
+    traceTransition(w, slot, TERMINATED, endCycle);
+  }
+  for (int r = 0; r < NUM_RESOURCES; r++)
+  {
+    if (w->holder[r] >= 0)
+    {
+      char name[32];
+      snprintf(name, sizeof(name), "P%d holds", w->holder[r]);
+      traceSlice(w, name, TRACE_RESOURCE_PID(r), 0, w->holdSince[r], endCycle);
+    }
+  }
+  fputs("\n]}\n", w->out);
+  bool ok = !ferror(w->out);
+  ok = fclose(w->out) == 0 && ok;
+  w->out = NULL;
+  return ok;
+}
+
 // ------------ Scheduling ------------
 
 static void addToReadyQueue(SystemState *sys, int pid)
@@ -322,12 +1145,13 @@ static void addToReadyQueue(SystemState *sys, int pid)
 
   if (sys->readySize >= MAX_QUEUE_SIZE)
   {
-    sim_log(sys, "Error: FCFS/RR Ready queue full, dropping P%d", pcb->programNumber);
+    sim_log(sys, SIM_LOG_SCHED, SIM_LOG_ERROR, "Error: FCFS/RR Ready queue full, dropping P%d", pcb->programNumber);
     // Consider terminating the process?
     pcb->state = TERMINATED; // Mark as terminated if dropped
     return;
   }
   pcb->state = READY;
+  pcb->readySince = sys->clockCycle;
   sys->readyQueue[sys->readyTail] = pid;
   sys->readyTail = (sys->readyTail + 1) % MAX_QUEUE_SIZE;
   sys->readySize++;
@@ -335,23 +1159,23 @@ static void addToReadyQueue(SystemState *sys, int pid)
 
 static void addToMLFQ(SystemState *sys, int pid, int level)
 {
-  if (level < 0 || level >= MLFQ_LEVELS)
+  if (level < 0 || level >= sys->mlfqLevels)
   {
-    sim_log(sys, "Error: Invalid MLFQ level %d for P%d", level, pid);
+    sim_log(sys, SIM_LOG_SCHED, SIM_LOG_ERROR, "Error: Invalid MLFQ level %d for P%d", level, pid);
     return;
   }
   if (sys->mlfqSize[level] >= MAX_QUEUE_SIZE)
   {
     // Policy: If the target queue is full, try the next lower priority queue.
     // If all lower queues are full, drop (or handle differently).
-    sim_log(sys, "Warning: MLFQ level %d full, trying next level for P%d", level, pid);
-    if (level + 1 < MLFQ_LEVELS)
+    sim_log(sys, SIM_LOG_SCHED, SIM_LOG_WARN, "Warning: MLFQ level %d full, trying next level for P%d", level, pid);
+    if (level + 1 < sys->mlfqLevels)
     {
       addToMLFQ(sys, pid, level + 1);
     }
     else
     {
-      sim_log(sys, "Error: All lower MLFQ levels full, dropping P%d", pid);
+      sim_log(sys, SIM_LOG_SCHED, SIM_LOG_ERROR, "Error: All lower MLFQ levels full, dropping P%d", pid);
       PCB *pcb = findPCB(sys, pid);
       if (pcb)
         pcb->state = TERMINATED; // Mark as terminated if dropped
@@ -363,20 +1187,21 @@ static void addToMLFQ(SystemState *sys, int pid, int level)
     return; // Should not happen
 
   pcb->state = READY;
+  pcb->readySince = sys->clockCycle;
   pcb->mlfqLevel = level;
   pcb->priority = level; // Priority matches level (lower level = higher priority)
 
   // If this process was unblocked this cycle, add it to the front of the queue
   if (sys->wasUnblockedThisCycle[pid])
   {
-    // Shift all existing processes one position forward
+    // Shift all existing processes one position towards the tail
     for (int i = sys->mlfqTail[level]; i != sys->mlfqHead[level]; i = (i - 1 + MAX_QUEUE_SIZE) % MAX_QUEUE_SIZE)
     {
       sys->mlfqRQ[level][i] = sys->mlfqRQ[level][(i - 1 + MAX_QUEUE_SIZE) % MAX_QUEUE_SIZE];
     }
-    // Add the unblocked process at the head
+    // Add the unblocked process at the head; the queue grew by one at the tail
     sys->mlfqRQ[level][sys->mlfqHead[level]] = pid;
-    sys->mlfqHead[level] = (sys->mlfqHead[level] - 1 + MAX_QUEUE_SIZE) % MAX_QUEUE_SIZE;
+    sys->mlfqTail[level] = (sys->mlfqTail[level] + 1) % MAX_QUEUE_SIZE;
   }
   else
   {
@@ -392,7 +1217,7 @@ static int scheduleNextProcess(SystemState *sys)
 {
   if (sys->schedulerType == SIM_SCHED_MLFQ)
   {
-    for (int lvl = 0; lvl < MLFQ_LEVELS; lvl++)
+    for (int lvl = 0; lvl < sys->mlfqLevels; lvl++)
     {
       if (sys->mlfqSize[lvl] > 0)
       {
@@ -424,7 +1249,7 @@ static void interpretInstruction(SystemState *sys, int pid)
   // Check if PCB exists and process is in RUNNING state (should be, but safety check)
   if (!pcb || pcb->state != RUNNING)
   {
-    sim_log(sys, "Error: Attempting to interpret instruction for non-running P%d (State: %d)", pid, pcb ? pcb->state : -1);
+    sim_log(sys, SIM_LOG_INTERP, SIM_LOG_ERROR, "Error: Attempting to interpret instruction for non-running P%d (State: %d)", pid, pcb ? (int)pcb->state : -1);
     // If it's somehow not running, maybe try to fix state or terminate?
     if (pcb)
       pcb->state = TERMINATED;  // Terminate if in inconsistent state
@@ -437,7 +1262,7 @@ static void interpretInstruction(SystemState *sys, int pid)
   // Check if Program Counter is valid
   if (pcb->programCounter >= instCount)
   {
-    sim_log(sys, "P%d reached end of program (PC=%d, InstCount=%d). Terminating.", pid, pcb->programCounter, instCount);
+    sim_log(sys, SIM_LOG_INTERP, SIM_LOG_INFO, "P%d reached end of program (PC=%d, InstCount=%d). Terminating.", pid, pcb->programCounter, instCount);
     pcb->state = TERMINATED;
     // Don't return yet, let the main loop handle termination cleanup this cycle
     return;
@@ -447,40 +1272,44 @@ static void interpretInstruction(SystemState *sys, int pid)
   int memIdx = pcb->memoryLowerBound + pcb->programCounter;
   if (memIdx < pcb->memoryLowerBound || memIdx > pcb->memoryUpperBound)
   {
-    sim_log(sys, "Error: P%d Program Counter (%d) resulted in invalid memory index %d. Terminating.", pid, pcb->programCounter, memIdx);
+    sim_log(sys, SIM_LOG_INTERP, SIM_LOG_ERROR, "Error: P%d Program Counter (%d) resulted in invalid memory index %d. Terminating.", pid, pcb->programCounter, memIdx);
     pcb->state = TERMINATED;
     sys->runningProcessID = -1;
     return;
   }
 
+  HOST_TIMER_BEGIN(opStart);
+  SimOpcode op = SIM_OP_UNKNOWN;
+
   // Make a mutable copy of the instruction line for strtok
   char line[MAX_LINE_LENGTH];
   strncpy(line, sys->memory[memIdx].value, MAX_LINE_LENGTH - 1);
   line[MAX_LINE_LENGTH - 1] = '\0'; // Ensure null termination
 
-  // Make another copy for logging, as strtok modifies the string
-  char line_copy_for_log[MAX_LINE_LENGTH];
-  strncpy(line_copy_for_log, line, MAX_LINE_LENGTH - 1);
-  line_copy_for_log[MAX_LINE_LENGTH - 1] = '\0';
-
-  sim_log(sys, "P%d Executing [PC=%d]: %s", pcb->programNumber, pcb->programCounter, line_copy_for_log);
+  // Logged before tokenizing, as strtok modifies the line
+  sim_event(sys, SIM_EV_EXECUTE, pid, pcb->programNumber, pcb->programCounter, 0, 0, line);
+  sys->instructionsExecuted++;
 
-  // Tokenize the instruction line
-  char *cmd = strtok(line, " ");
-  char *a1 = strtok(NULL, " ");
-  char *a2 = strtok(NULL, " ");
-  char *a3 = strtok(NULL, " "); // For potential 3-argument instructions like 'assign b readFile a'
+  // Tokenize the instruction line (strtok_r: independent SystemStates may run on parallel threads)
+  char *save = NULL;
+  char *cmd = strtok_r(line, " ", &save);
+  char *a1 = strtok_r(NULL, " ", &save);
+  char *a2 = strtok_r(NULL, " ", &save);
+  char *a3 = strtok_r(NULL, " ", &save); // For potential 3-argument instructions like 'assign b readFile a'
 
   bool error = false;
   bool instruction_completed = true; // Assume completion unless blocked or input needed
+  sys->fs.ioLogCount = 0; // The store blocks this instruction moves, for the disk
 
   if (!cmd || strlen(cmd) == 0)
   {
     // Empty line or NOP - just advance PC
-    sim_log(sys, "P%d: NOP instruction", pcb->programNumber);
+    op = SIM_OP_NOP;
+    sim_log(sys, SIM_LOG_INTERP, SIM_LOG_DEBUG, "P%d: NOP instruction", pcb->programNumber);
   }
   else if (strcmp(cmd, "print") == 0)
   {
+    op = SIM_OP_PRINT;
     if (a1)
       do_print(sys, pid, a1);
     else
@@ -488,9 +1317,10 @@ static void interpretInstruction(SystemState *sys, int pid)
   }
   else if (strcmp(cmd, "assign") == 0)
   {
+    op = SIM_OP_ASSIGN;
     if (!a1 || !a2)
     {
-      sim_log(sys, "Error in P%d: assign requires variable name and value/source.", pcb->programNumber);
+      sim_log(sys, SIM_LOG_INTERP, SIM_LOG_ERROR, "Error in P%d: assign requires variable name and value/source.", pcb->programNumber);
       error = true;
     }
     else if (strcmp(a2, "readFile") == 0 && a3)
@@ -517,7 +1347,7 @@ static void interpretInstruction(SystemState *sys, int pid)
           char *content = getVariable(sys, pid, tempVarName);
           if (!content)
           {
-            sim_log(sys, "Error in P%d: readFile intermediate variable %s not found after read.", pcb->programNumber, tempVarName);
+            sim_log(sys, SIM_LOG_IO, SIM_LOG_ERROR, "Error in P%d: readFile intermediate variable %s not found after read.", pcb->programNumber, tempVarName);
             error = true;
           }
           else
@@ -533,14 +1363,15 @@ static void interpretInstruction(SystemState *sys, int pid)
     {
       // Normal assign (including assign b input)
       do_assign(sys, pid, a1, a2);
-      if (sys->needsInput && sys->inputPid == pid)
-        instruction_completed = false;
+      if (pcb->inputWaiting)
+        instruction_completed = false; // provideInput completes it
       if (pcb->state == TERMINATED)
         error = true;
     }
   }
   else if (strcmp(cmd, "writeFile") == 0)
   {
+    op = SIM_OP_WRITE_FILE;
     if (a1 && a2)
       do_writeFile(sys, pid, a1, a2);
     else
@@ -548,6 +1379,7 @@ static void interpretInstruction(SystemState *sys, int pid)
   }
   else if (strcmp(cmd, "readFile") == 0)
   { // Direct readFile instruction (legacy?)
+    op = SIM_OP_READ_FILE;
     if (a1)
       do_readFile(sys, pid, a1); // Reads into "file_<a1>"
     else
@@ -555,6 +1387,7 @@ static void interpretInstruction(SystemState *sys, int pid)
   }
   else if (strcmp(cmd, "printFromTo") == 0)
   {
+    op = SIM_OP_PRINT_FROM_TO;
     if (a1 && a2)
       do_printFromTo(sys, pid, a1, a2);
     else
@@ -562,6 +1395,7 @@ static void interpretInstruction(SystemState *sys, int pid)
   }
   else if (strcmp(cmd, "semWait") == 0)
   {
+    op = SIM_OP_SEM_WAIT;
     if (a1)
     {
       do_semWait(sys, pid, a1);
@@ -576,6 +1410,7 @@ static void interpretInstruction(SystemState *sys, int pid)
   }
   else if (strcmp(cmd, "semSignal") == 0)
   {
+    op = SIM_OP_SEM_SIGNAL;
     if (a1)
       do_semSignal(sys, pid, a1);
     else
@@ -583,17 +1418,24 @@ static void interpretInstruction(SystemState *sys, int pid)
   }
   else
   {
-    sim_log(sys, "Error in P%d: Unknown command '%s'", pcb->programNumber, cmd ? cmd : "<null>");
+    sim_log(sys, SIM_LOG_INTERP, SIM_LOG_ERROR, "Error in P%d: Unknown command '%s'", pcb->programNumber, cmd ? cmd : "<null>");
     error = true;
   }
 
   if (error)
   {
-    sim_log(sys, "Error processing instruction for P%d. Terminating.", pcb->programNumber);
+    sim_log(sys, SIM_LOG_INTERP, SIM_LOG_ERROR, "Error processing instruction for P%d. Terminating.", pcb->programNumber);
     pcb->state = TERMINATED;
     instruction_completed = true; // Error means instruction effect is termination
   }
 
+  // Blocks moved to or from the store make the process wait for the disk
+  if (sys->fs.ioLogCount > 0 && diskEnabled(sys) && pcb->state == RUNNING && instruction_completed)
+  {
+    diskSubmit(sys, pcb);
+    instruction_completed = false; // diskTick completes it
+  }
+
   // --- Post-instruction processing ---
 
   // If the instruction completed successfully and didn't block/request input/terminate, advance PC.
@@ -606,10 +1448,11 @@ static void interpretInstruction(SystemState *sys, int pid)
     int newInstCount = findInstructionCount(sys, pid); // Recalculate just in case? (unlikely needed)
     if (pcb->programCounter >= newInstCount)
     {
-      sim_log(sys, "P%d finished program after instruction (PC=%d, InstCount=%d). Terminating.", pcb->programNumber, pcb->programCounter, newInstCount);
+      sim_event(sys, SIM_EV_PROGRAM_END, pid, pcb->programNumber, pcb->programCounter, newInstCount, 0, NULL);
       pcb->state = TERMINATED;
     }
   }
+  HOST_TIMER_END(sys->hostProfile.opcode[op], opStart);
   // State transitions (TERMINATED, BLOCKED) are handled within the instruction handlers
   // or in the main stepSimulation loop after interpretInstruction returns.
 }
@@ -682,21 +1525,21 @@ static void setVariable(SystemState *sys, int pid, const char *varName, const ch
   // Check for invalid variable names (e.g., empty)
   if (!varName || varName[0] == '\0')
   {
-    sim_log(sys, "Error in P%d: Attempt to set variable with empty name.", pcb->programNumber);
+    sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error in P%d: Attempt to set variable with empty name.", pcb->programNumber);
     pcb->state = TERMINATED;
     return;
   }
   // Check for potentially problematic names (though less critical now)
   if (strcmp(varName, "input") == 0 || strcmp(varName, "readFile") == 0)
   {
-    sim_log(sys, "Warning in P%d: Setting variable with reserved name '%s'.", pcb->programNumber, varName);
+    sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_WARN, "Warning in P%d: Setting variable with reserved name '%s'.", pcb->programNumber, varName);
   }
 
   int memIndex = findVariableMemoryIndex(sys, pid, varName, true); // Find existing or first free slot
 
   if (memIndex < 0)
   {
-    sim_log(sys, "Error in P%d: No free memory slot found for variable '%s'. Terminating.", pcb->programNumber, varName);
+    sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error in P%d: No free memory slot found for variable '%s'. Terminating.", pcb->programNumber, varName);
     pcb->state = TERMINATED;
     return;
   }
@@ -706,7 +1549,7 @@ static void setVariable(SystemState *sys, int pid, const char *varName, const ch
   strncpy(sys->memory[memIndex].value, value, sizeof(sys->memory[0].value) - 1);
   sys->memory[memIndex].value[sizeof(sys->memory[0].value) - 1] = '\0'; // Ensure null termination
 
-  // sim_log(sys, "P%d: Set variable '%s' = '%s' (at mem %d)", pcb->programNumber, varName, value, memIndex);
+  // sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_DEBUG, "P%d: Set variable '%s' = '%s' (at mem %d)", pcb->programNumber, varName, value, memIndex);
 }
 
 // Get variable value - declared in .h for potential GUI use
@@ -718,7 +1561,7 @@ char *getVariable(SystemState *sys, int pid, const char *varName)
 
   if (!varName || varName[0] == '\0')
   {
-    sim_log(sys, "Error in P%d: Attempt to get variable with empty name.", pcb->programNumber);
+    sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error in P%d: Attempt to get variable with empty name.", pcb->programNumber);
     pcb->state = TERMINATED;
     return NULL;
   }
@@ -735,7 +1578,7 @@ char *getVariable(SystemState *sys, int pid, const char *varName)
 
     if (memIndex < 0)
     {
-      sim_log(sys, "Error in P%d: Variable '%s' not found.", pcb->programNumber, varName);
+      sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error in P%d: Variable '%s' not found.", pcb->programNumber, varName);
       pcb->state = TERMINATED;
       return NULL;
     }
@@ -746,6 +1589,681 @@ char *getVariable(SystemState *sys, int pid, const char *varName)
   return sys->memory[memIndex].value;
 }
 
+// -------- Simulated Filesystem --------
+
+static int fsBlocksFor(size_t bytes)
+{
+  return (int)((bytes + FS_BLOCK_SIZE - 1) / FS_BLOCK_SIZE);
+}
+
+static void fsInit(SimFs *fs)
+{
+  fs->freeBlocks = FS_BLOCKS;
+  fs->inodes[0].used = true; // Root directory
+  fs->inodes[0].isDir = true;
+  fs->cacheSize = FS_CACHE_DEFAULT;
+  fs->cachePolicy = FS_CACHE_LRU;
+}
+
+static void fsLogIo(SimFs *fs, int block)
+{
+  if (fs->ioLogCount < FS_IO_LOG_SIZE)
+    fs->ioLog[fs->ioLogCount] = (short)block;
+  fs->ioLogCount++;
+}
+
+static void fsWriteBack(SimFs *fs, FsBuffer *b)
+{
+  if (!b->dirty)
+    return;
+  memcpy(fs->store[b->block], b->data, FS_BLOCK_SIZE);
+  fsLogIo(fs, b->block);
+  b->dirty = false;
+  fs->cacheStats.diskWrites++;
+}
+
+static FsBuffer *fsVictim(SimFs *fs)
+{
+  for (int i = 0; i < fs->cacheSize; i++)
+    if (!fs->buffers[i].valid)
+      return &fs->buffers[i];
+  if (fs->cachePolicy == FS_CACHE_CLOCK)
+  {
+    for (;;) // Terminates within two sweeps: the first clears every reference bit
+    {
+      FsBuffer *b = &fs->buffers[fs->clockHand];
+      fs->clockHand = (fs->clockHand + 1) % fs->cacheSize;
+      if (!b->referenced)
+        return b;
+      b->referenced = false;
+    }
+  }
+  FsBuffer *oldest = &fs->buffers[0];
+  for (int i = 1; i < fs->cacheSize; i++)
+    if (fs->buffers[i].lastUse < oldest->lastUse)
+      oldest = &fs->buffers[i];
+  return oldest;
+}
+
+// The bytes of `block` for one access, through the cache when enabled. `fresh` means a write
+// replaces everything the block holds, so a miss need not read the store first.
+static unsigned char *fsBlock(SimFs *fs, int block, bool write, bool fresh)
+{
+  FsCacheStats *st = &fs->cacheStats;
+  if (write)
+    st->writes++;
+  else
+    st->reads++;
+  if (fs->cacheSize == 0)
+  {
+    fsLogIo(fs, block);
+    if (write)
+      st->diskWrites++;
+    else
+      st->diskReads++;
+    return fs->store[block];
+  }
+  FsBuffer *b;
+  if (fs->bufferOf[block])
+  {
+    b = &fs->buffers[fs->bufferOf[block] - 1];
+    st->hits++;
+    if (write && b->dirty)
+      st->coalesced++;
+  }
+  else
+  {
+    st->misses++;
+    b = fsVictim(fs);
+    if (b->valid)
+    {
+      st->evictions++;
+      fsWriteBack(fs, b);
+      fs->bufferOf[b->block] = 0;
+    }
+    b->valid = true;
+    b->dirty = false;
+    b->block = (short)block;
+    fs->bufferOf[block] = (unsigned char)(b - fs->buffers + 1);
+    if (!write || !fresh)
+    {
+      memcpy(b->data, fs->store[block], FS_BLOCK_SIZE);
+      fsLogIo(fs, block);
+      st->diskReads++;
+    }
+  }
+  b->lastUse = ++fs->cacheTick;
+  b->referenced = true;
+  if (write)
+    b->dirty = true;
+  return b->data;
+}
+
+// Forgets a freed block's buffer; dirty contents are dropped, not written
+static void fsDropBlock(SimFs *fs, int block)
+{
+  if (!fs->bufferOf[block])
+    return;
+  FsBuffer *b = &fs->buffers[fs->bufferOf[block] - 1];
+  b->valid = false;
+  b->dirty = false;
+  fs->bufferOf[block] = 0;
+}
+
+void setFsCache(SystemState *sys, int buffers, FsCachePolicy policy, bool flushOnExit)
+{
+  SimFs *fs = &sys->fs;
+  fsFlush(sys);
+  for (int i = 0; i < fs->cacheSize; i++)
+    if (fs->buffers[i].valid)
+      fsDropBlock(fs, fs->buffers[i].block);
+  fs->cacheSize = buffers < 0 ? 0 : buffers > FS_CACHE_MAX ? FS_CACHE_MAX : buffers;
+  fs->cachePolicy = policy;
+  fs->flushOnExit = flushOnExit;
+  fs->clockHand = 0;
+  memset(&fs->cacheStats, 0, sizeof(fs->cacheStats));
+}
+
+void fsFlush(SystemState *sys)
+{
+  SimFs *fs = &sys->fs;
+  bool any = false;
+  for (int i = 0; i < fs->cacheSize; i++)
+  {
+    any = any || fs->buffers[i].dirty;
+    fsWriteBack(fs, &fs->buffers[i]);
+  }
+  if (any)
+    fs->cacheStats.flushes++;
+}
+
+// First free block from the inode's group on, so different files land on different tracks
+static short fsAllocBlock(SimFs *fs, const FsInode *node)
+{
+  int start = (int)(node - fs->inodes) % FS_GROUPS * (FS_BLOCKS / FS_GROUPS);
+  for (int i = 0; i < FS_BLOCKS; i++)
+  {
+    int b = (start + i) % FS_BLOCKS;
+    if (!fs->blockUsed[b])
+    {
+      fs->blockUsed[b] = true;
+      fs->freeBlocks--;
+      return (short)b;
+    }
+  }
+  return -1; // Callers check freeBlocks first
+}
+
+static void fsFreeBlock(SimFs *fs, int block)
+{
+  fsDropBlock(fs, block);
+  fs->blockUsed[block] = false;
+  fs->freeBlocks++;
+}
+
+// Blocks a file of `bytes` occupies, counting its indirect block
+static int fsBlocksNeeded(size_t bytes)
+{
+  int data = fsBlocksFor(bytes);
+  return data + (data > FS_DIRECT_BLOCKS ? 1 : 0);
+}
+
+// Block number of the file's i-th block; indirect entries are read through the cache
+static short fsBlockAt(SimFs *fs, const FsInode *node, int i)
+{
+  if (i < FS_DIRECT_BLOCKS)
+    return node->blocks[i];
+  short block;
+  memcpy(&block, fsBlock(fs, node->indirect, false, false) + (i - FS_DIRECT_BLOCKS) * sizeof(short), sizeof(block));
+  return block;
+}
+
+// As fsBlockAt, but from the store itself: only valid right after fsFlush
+static short fsStoredBlockAt(const SimFs *fs, const FsInode *node, int i)
+{
+  if (i < FS_DIRECT_BLOCKS)
+    return node->blocks[i];
+  short block;
+  memcpy(&block, fs->store[node->indirect] + (i - FS_DIRECT_BLOCKS) * sizeof(short), sizeof(block));
+  return block;
+}
+
+static void fsSetBlockAt(SimFs *fs, FsInode *node, int i, short block)
+{
+  if (i < FS_DIRECT_BLOCKS)
+  {
+    node->blocks[i] = block;
+    return;
+  }
+  // The first indirect entry is only set right after the indirect block is allocated
+  unsigned char *entries = fsBlock(fs, node->indirect, true, i == FS_DIRECT_BLOCKS);
+  memcpy(entries + (i - FS_DIRECT_BLOCKS) * sizeof(short), &block, sizeof(block));
+}
+
+// Shrinks node to size bytes (no larger than it is), freeing the blocks past the end
+static void fsTruncate(SimFs *fs, FsInode *node, int size)
+{
+  int keep = fsBlocksFor(size), have = fsBlocksFor(node->size);
+  for (int i = keep; i < have; i++)
+    fsFreeBlock(fs, fsBlockAt(fs, node, i));
+  if (have > FS_DIRECT_BLOCKS && keep <= FS_DIRECT_BLOCKS)
+    fsFreeBlock(fs, node->indirect);
+  node->size = size;
+}
+
+static size_t fsReadAt(SimFs *fs, const FsInode *node, size_t off, void *buf, size_t len)
+{
+  if (off >= (size_t)node->size)
+    return 0;
+  if (len > node->size - off)
+    len = node->size - off;
+  for (size_t done = 0; done < len;)
+  {
+    size_t pos = off + done, in = pos % FS_BLOCK_SIZE;
+    size_t chunk = FS_BLOCK_SIZE - in < len - done ? FS_BLOCK_SIZE - in : len - done;
+    memcpy((char *)buf + done, fsBlock(fs, fsBlockAt(fs, node, (int)(pos / FS_BLOCK_SIZE)), false, false) + in, chunk);
+    done += chunk;
+  }
+  return len;
+}
+
+// Writes at `off`, growing the file; false (nothing written) if it would not fit
+static bool fsWriteAt(SimFs *fs, FsInode *node, size_t off, const void *buf, size_t len)
+{
+  size_t end = off + len;
+  int have = fsBlocksFor(node->size), need = fsBlocksFor(end);
+  if (end > FS_MAX_FILE_SIZE || fsBlocksNeeded(end) - fsBlocksNeeded(node->size) > fs->freeBlocks)
+    return false;
+  if (need > FS_DIRECT_BLOCKS && have <= FS_DIRECT_BLOCKS)
+    node->indirect = fsAllocBlock(fs, node);
+  for (int i = have; i < need; i++)
+    fsSetBlockAt(fs, node, i, fsAllocBlock(fs, node));
+  for (size_t done = 0; done < len;)
+  {
+    size_t pos = off + done, in = pos % FS_BLOCK_SIZE;
+    size_t chunk = FS_BLOCK_SIZE - in < len - done ? FS_BLOCK_SIZE - in : len - done;
+    bool fresh = (int)(pos / FS_BLOCK_SIZE) >= have ||
+                 (in == 0 && (chunk == FS_BLOCK_SIZE || pos + chunk >= (size_t)node->size));
+    memcpy(fsBlock(fs, fsBlockAt(fs, node, (int)(pos / FS_BLOCK_SIZE)), true, fresh) + in, (const char *)buf + done,
+           chunk);
+    done += chunk;
+  }
+  if (end > (size_t)node->size)
+    node->size = (int)end;
+  return true;
+}
+
+static int fsDirFind(SimFs *fs, int dir, const char *name)
+{
+  const FsInode *node = &fs->inodes[dir];
+  FsDirEntry e;
+  for (size_t off = 0; off < (size_t)node->size; off += sizeof(e))
+  {
+    fsReadAt(fs, node, off, &e, sizeof(e));
+    if (strcmp(e.name, name) == 0)
+      return e.inode;
+  }
+  return -1;
+}
+
+static int fsCreate(SimFs *fs, int dir, const char *name, bool isDir)
+{
+  int ino = 1;
+  while (ino < FS_INODES && fs->inodes[ino].used)
+    ino++;
+  if (ino == FS_INODES)
+    return -1;
+  FsDirEntry e;
+  memset(&e, 0, sizeof(e));
+  snprintf(e.name, sizeof(e.name), "%s", name);
+  e.inode = (short)ino;
+  if (!fsWriteAt(fs, &fs->inodes[dir], fs->inodes[dir].size, &e, sizeof(e)))
+    return -1;
+  FsInode *node = &fs->inodes[ino];
+  memset(node, 0, sizeof(*node));
+  node->used = true;
+  node->isDir = isDir;
+  return ino;
+}
+
+// Frees file ino, its blocks and the directory entry naming it
+static void fsRemove(SimFs *fs, int ino)
+{
+  FsDirEntry e, last;
+  for (int dir = 0; dir < FS_INODES; dir++)
+  {
+    FsInode *dirNode = &fs->inodes[dir];
+    if (!dirNode->used || !dirNode->isDir)
+      continue;
+    for (size_t off = 0; off < (size_t)dirNode->size; off += sizeof(e))
+    {
+      fsReadAt(fs, dirNode, off, &e, sizeof(e));
+      if (e.inode != ino)
+        continue;
+      size_t end = dirNode->size - sizeof(e);
+      fsReadAt(fs, dirNode, end, &last, sizeof(last));
+      fsWriteAt(fs, dirNode, off, &last, sizeof(last)); // The last entry takes its place
+      fsTruncate(fs, dirNode, (int)end);
+      break;
+    }
+  }
+  fsTruncate(fs, &fs->inodes[ino], 0);
+  fs->inodes[ino].used = false;
+}
+
+// Walks path from the root; with create, missing directories and the final file are made.
+// Returns the inode, or -1 if it does not exist (or could not be made) or the path is invalid.
+// An absolute path starts at the root's "/" directory; ".." is an ordinary name.
+static int fsResolve(SimFs *fs, const char *path, bool create)
+{
+  int ino = 0;
+  const char *p = path;
+  bool absolute = path[0] == '/';
+  for (;;)
+  {
+    p += strspn(p, "/");
+    if (*p == '\0' && !absolute)
+      return ino;
+    size_t n = absolute ? 1 : strcspn(p, "/");
+    char name[FS_NAME_LENGTH];
+    if (n >= sizeof(name) || !fs->inodes[ino].isDir)
+      return -1;
+    memcpy(name, absolute ? "/" : p, n);
+    name[n] = '\0';
+    bool hostRoot = absolute;
+    if (!absolute)
+      p += n;
+    absolute = false;
+    if (strcmp(name, ".") == 0)
+      continue;
+    int next = fsDirFind(fs, ino, name);
+    if (next < 0)
+    {
+      if (!create)
+        return -1;
+      bool last = p[strspn(p, "/")] == '\0';
+      next = fsCreate(fs, ino, name, !last || hostRoot);
+      if (next < 0)
+        return -1;
+    }
+    ino = next;
+  }
+}
+
+// Copies path from the host directory on first access; the inode, or -1
+static int fsImport(SystemState *sys, const char *path)
+{
+  SimFs *fs = &sys->fs;
+  if (fs->hostDir[0] == '\0')
+    return -1;
+  char hostPath[512];
+  if (path[0] == '/')
+    snprintf(hostPath, sizeof(hostPath), "%s", path);
+  else
+    snprintf(hostPath, sizeof(hostPath), "%s/%s", fs->hostDir, path);
+  FILE *f = fopen(hostPath, "rb");
+  if (!f)
+    return -1;
+  char data[FS_MAX_FILE_SIZE];
+  size_t len = fread(data, 1, sizeof(data), f);
+  if (len == sizeof(data) && fgetc(f) != EOF)
+    sim_log(sys, SIM_LOG_IO, SIM_LOG_WARN, "Warning: '%s' is larger than %zu bytes; imported truncated.", hostPath,
+            sizeof(data));
+  bool readError = ferror(f);
+  fclose(f);
+  if (readError)
+  {
+    sim_log(sys, SIM_LOG_IO, SIM_LOG_WARN, "Warning: error reading '%s'; not imported.", hostPath);
+    return -1;
+  }
+  int ino = fsResolve(fs, path, true);
+  if (ino < 0 || fs->inodes[ino].isDir || !fsWriteAt(fs, &fs->inodes[ino], 0, data, len))
+  {
+    sim_log(sys, SIM_LOG_IO, SIM_LOG_WARN, "Warning: no room to import '%s' into the simulated filesystem.", hostPath);
+    if (ino > 0 && !fs->inodes[ino].isDir)
+      fsRemove(fs, ino); // Just created: an empty file would hide the host one from later reads
+    return -1;
+  }
+  return ino;
+}
+
+void setFsHostDir(SystemState *sys, const char *dir, bool writeBack)
+{
+  snprintf(sys->fs.hostDir, sizeof(sys->fs.hostDir), "%s", dir ? dir : "");
+  sys->fs.writeBack = dir && writeBack;
+}
+
+bool fsWriteFile(SystemState *sys, const char *path, const char *data, size_t len)
+{
+  SimFs *fs = &sys->fs;
+  int ino = fsResolve(fs, path, true);
+  if (ino < 0 || fs->inodes[ino].isDir)
+    return false;
+  FsInode *node = &fs->inodes[ino];
+  if (len > FS_MAX_FILE_SIZE || fsBlocksNeeded(len) > fsBlocksNeeded(node->size) + fs->freeBlocks)
+    return false; // Checked up front so a failed write leaves the old contents
+  fsTruncate(fs, node, (int)len < node->size ? (int)len : node->size); // Rewrites reuse the cached blocks
+  fsWriteAt(fs, node, 0, data, len);
+  node->dirty = true;
+  return true;
+}
+
+int fsReadFile(SystemState *sys, const char *path, char *buf, size_t size)
+{
+  SimFs *fs = &sys->fs;
+  int ino = fsResolve(fs, path, false);
+  if (ino < 0)
+    ino = fsImport(sys, path);
+  if (ino < 0 || fs->inodes[ino].isDir)
+    return -1;
+  const FsInode *node = &fs->inodes[ino];
+  if (size > 0)
+    buf[fsReadAt(fs, node, 0, buf, size - 1)] = '\0';
+  return node->size;
+}
+
+// Writes the changed files under dir; `path` holds dir's host path and has room to extend it
+static int fsExportDir(SimFs *fs, int dir, char *path, size_t size)
+{
+  const FsInode *dirNode = &fs->inodes[dir];
+  size_t base = strlen(path);
+  int written = 0;
+  FsDirEntry e;
+  for (size_t off = 0; off < (size_t)dirNode->size; off += sizeof(e))
+  {
+    fsReadAt(fs, dirNode, off, &e, sizeof(e));
+    FsInode *node = &fs->inodes[e.inode];
+    if (dir == 0 && strcmp(e.name, "/") == 0)
+    { // Absolute paths go back where they came from
+      char absPath[1024] = "";
+      int n = fsExportDir(fs, e.inode, absPath, sizeof(absPath));
+      if (n < 0)
+      {
+        snprintf(path, size, "%s", absPath); // For the caller's error message
+        return -1;
+      }
+      written += n;
+      continue;
+    }
+    if ((size_t)snprintf(path + base, size - base, "/%s", e.name) >= size - base)
+      return -1;
+    if (node->isDir)
+    {
+      if (mkdir(path, 0777) != 0 && errno != EEXIST)
+        return -1;
+      int n = fsExportDir(fs, e.inode, path, size);
+      if (n < 0)
+        return -1;
+      written += n;
+    }
+    else if (node->dirty)
+    {
+      FILE *f = fopen(path, "wb");
+      if (!f)
+        return -1;
+      for (int i = 0; i < fsBlocksFor(node->size); i++)
+      {
+        int chunk = node->size - i * FS_BLOCK_SIZE < FS_BLOCK_SIZE ? node->size - i * FS_BLOCK_SIZE : FS_BLOCK_SIZE;
+        fwrite(fs->store[fsStoredBlockAt(fs, node, i)], 1, chunk, f);
+      }
+      if (fclose(f) != 0)
+        return -1;
+      node->dirty = false;
+      written++;
+    }
+    path[base] = '\0';
+  }
+  return written;
+}
+
+int fsExport(SystemState *sys)
+{
+  if (sys->fs.hostDir[0] == '\0')
+    return 0;
+  char path[1024];
+  snprintf(path, sizeof(path), "%s", sys->fs.hostDir);
+  fsFlush(sys); // Exported from the store
+  int written = fsExportDir(&sys->fs, 0, path, sizeof(path));
+  if (written < 0)
+    sim_log(sys, SIM_LOG_IO, SIM_LOG_ERROR, "Error exporting files to '%s': %s", path, strerror(errno));
+  return written;
+}
+
+// -------- Disk Model --------
+
+void setDiskModel(SystemState *sys, int seekCycles, int transferCycles)
+{
+  sys->disk.seekCycles = seekCycles > 0 ? seekCycles : 0;
+  sys->disk.transferCycles = transferCycles > 0 ? transferCycles : 0;
+}
+
+void setDiskPolicy(SystemState *sys, DiskPolicy policy)
+{
+  sys->disk.policy = policy;
+}
+
+static bool diskEnabled(const SystemState *sys)
+{
+  return sys->disk.seekCycles > 0 || sys->disk.transferCycles > 0;
+}
+
+// Queues the store blocks in the I/O log as requests for pid (-1: nobody waits for them),
+// one per run of blocks on the same track. Returns the number of requests queued.
+static int diskQueueLogged(SystemState *sys, int pid)
+{
+  SimDisk *d = &sys->disk;
+  const SimFs *fs = &sys->fs;
+  int logged = fs->ioLogCount < FS_IO_LOG_SIZE ? fs->ioLogCount : FS_IO_LOG_SIZE;
+  DiskRequest *req = NULL;
+  int queued = 0;
+  for (int i = 0; i < logged; i++)
+  {
+    int track = fs->ioLog[i] / DISK_BLOCKS_PER_TRACK;
+    if (!req && pid < 0 && d->queued >= DISK_QUEUE_SIZE)
+      req = &d->queue[d->queued - 1]; // Only processes are sure of a slot: ride on the newest request
+    if (req && (req->track == track || d->queued >= DISK_QUEUE_SIZE))
+    {
+      req->blocks++; // Same track: no seek in between
+      continue;
+    }
+    req = &d->queue[d->queued++];
+    req->pid = pid;
+    req->track = track;
+    req->blocks = 1;
+    req->issued = sys->clockCycle + 1; // Queued from the next cycle on
+    queued++;
+  }
+  req->blocks += fs->ioLogCount - logged; // Beyond the log: charged without seeks
+  return queued;
+}
+
+// Blocks pcb until the disk has moved the store blocks its current instruction logged
+static void diskSubmit(SystemState *sys, PCB *pcb)
+{
+  const SimFs *fs = &sys->fs;
+  pcb->diskPending += diskQueueLogged(sys, pcb->processID);
+  pcb->state = BLOCKED;
+  pcb->diskWaiting = true;
+  pcb->blockedSince = sys->clockCycle + 1;
+  if (sys->runningProcessID == pcb->processID)
+    sys->runningProcessID = -1;
+  sim_event(sys, SIM_EV_DISK_WAIT, pcb->processID, pcb->programNumber, fs->ioLog[0] / DISK_BLOCKS_PER_TRACK,
+            fs->ioLogCount, 0, NULL);
+  notify_state_update(sys);
+}
+
+// Writes the dirty buffers back when a process terminates (flushOnExit). With a disk model the
+// blocks the terminating instruction and the flush move are queued like anyone else's traffic
+// and delay it, but nobody waits for them; the run completes once the disk is idle.
+static void fsFlushOnExit(SystemState *sys)
+{
+  if (!sys->fs.flushOnExit)
+    return;
+  fsFlush(sys);
+  if (sys->fs.ioLogCount > 0 && diskEnabled(sys))
+    diskQueueLogged(sys, -1);
+  sys->fs.ioLogCount = 0;
+}
+
+// Oldest queued request nearest to track `from` in direction dir (1 up, -1 down), or -1
+static int diskNearestFrom(const SimDisk *d, int from, int dir)
+{
+  int best = -1, bestDelta = 0;
+  for (int i = 0; i < d->queued; i++)
+  {
+    int delta = (d->queue[i].track - from) * dir;
+    if (delta >= 0 && (best < 0 || delta < bestDelta))
+    {
+      best = i;
+      bestDelta = delta;
+    }
+  }
+  return best;
+}
+
+// The queued request to serve next under d->policy; *distance is the head travel it costs
+static int diskPickNext(SimDisk *d, int *distance)
+{
+  int best = 0, head = d->head, last = DISK_TRACKS - 1;
+  switch (d->policy)
+  {
+  case DISK_FCFS:
+    break;
+  case DISK_SSTF:
+    for (int i = 1; i < d->queued; i++)
+      if (abs(d->queue[i].track - head) < abs(d->queue[best].track - head))
+        best = i;
+    break;
+  case DISK_SCAN:
+  case DISK_CSCAN:
+  case DISK_CLOOK:
+  {
+    int dir = d->policy == DISK_SCAN ? d->direction : 1;
+    best = diskNearestFrom(d, head, dir);
+    if (best >= 0)
+      break;
+    if (d->policy == DISK_SCAN)
+    { // Nothing ahead: finish the sweep at the edge and come back
+      int edge = dir > 0 ? last : 0;
+      d->direction = -dir;
+      best = diskNearestFrom(d, head, -dir);
+      *distance = abs(edge - head) + abs(edge - d->queue[best].track);
+      return best;
+    }
+    best = diskNearestFrom(d, 0, 1);
+    int track = d->queue[best].track;
+    *distance = d->policy == DISK_CSCAN ? (last - head) + last + track : head - track;
+    return best;
+  }
+  }
+  *distance = abs(d->queue[best].track - head);
+  return best;
+}
+
+// Advances the disk by one cycle, before this cycle's dispatch: a finished request readies
+// its process, and an idle disk starts the next queued one its policy picks.
+static void diskTick(SystemState *sys)
+{
+  SimDisk *d = &sys->disk;
+  if (d->busy)
+  {
+    d->busyCycles++;
+    if (--d->remaining == 0)
+    {
+      d->busy = false;
+      int latency = sys->clockCycle - d->current.issued;
+      latencyRecord(&d->latency, latency);
+      PCB *pcb = findPCB(sys, d->current.pid);
+      if (pcb && pcb->diskWaiting && --pcb->diskPending == 0)
+      {
+        pcb->diskWaiting = false;
+        pcb->diskCycles += sys->clockCycle - pcb->blockedSince;
+        LineProfile *lp = lineProfileAt(sys, pcb);
+        if (lp)
+          lp->diskWait += sys->clockCycle - pcb->blockedSince;
+        finishBlockedInstruction(sys, pcb, SIM_EV_DISK_DONE, latency);
+        notify_state_update(sys);
+      }
+    }
+  }
+  if (!d->busy && d->queued > 0)
+  {
+    int distance;
+    int next = diskPickNext(d, &distance);
+    d->current = d->queue[next];
+    d->queued--;
+    memmove(d->queue + next, d->queue + next + 1, (d->queued - next) * sizeof(d->queue[0]));
+    d->head = d->current.track;
+    d->remaining = distance * d->seekCycles + d->current.blocks * d->transferCycles;
+    if (d->remaining < 1)
+      d->remaining = 1; // A request takes at least the cycle it is served in
+    d->busy = true;
+    d->requests++;
+    d->blocks += d->current.blocks;
+    d->seekTracks += distance;
+  }
+}
+
 // -------- Instruction Handlers --------
 
 static void do_print(SystemState *sys, int pid, char *varName)
@@ -765,22 +2283,39 @@ static void do_assign(SystemState *sys, int pid, char *varName, char *valueOrSou
 
   if (strcmp(valueOrSource, "input") == 0)
   {
+    const char *scripted = takeScriptedInput(sys, pcb, varName);
+    if (scripted)
+    {
+      // Answered on the spot: the instruction completes like a plain assign
+      sim_log(sys, SIM_LOG_IO, SIM_LOG_INFO, "P%d received scripted input '%s' for variable '%s'", pcb->programNumber,
+              scripted, varName);
+      setVariable(sys, pid, varName, scripted);
+    }
     // Request input via callback
-    if (sys->callbacks && sys->callbacks->request_input)
-    {
-      sim_log(sys, "P%d needs input for variable '%s'", pcb->programNumber, varName);
-      sys->needsInput = true;
-      strncpy(sys->inputVarName, varName, sizeof(sys->inputVarName) - 1);
-      sys->inputVarName[sizeof(sys->inputVarName) - 1] = '\0';
-      sys->inputPid = pid;
-      // Execution will pause here for this process. stepSimulation will return.
-      // GUI should call request_input, get value, then call provideInput.
+    else if (sys->callbacks && sys->callbacks->request_input)
+    {
+      LineProfile *lp = lineProfileAt(sys, pcb);
+      if (lp)
+        lp->inputStalls++;
+      // An I/O wait: only this process stops, until provideInput answers it
+      InputRequest *req = &sys->inputRequests[(sys->inputRequestHead + sys->inputRequestCount) % MAX_PROCESSES];
+      sys->inputRequestCount++; // At most one per process, so the ring cannot overflow
+      req->pid = pid;
+      strncpy(req->varName, varName, sizeof(req->varName) - 1);
+      req->varName[sizeof(req->varName) - 1] = '\0';
+      pcb->state = BLOCKED;
+      pcb->inputWaiting = true;
+      pcb->blockedSince = sys->clockCycle;
+      if (sys->runningProcessID == pid)
+        sys->runningProcessID = -1;
+      syncPendingInput(sys);
+      sim_event(sys, SIM_EV_INPUT_WAIT, pid, pcb->programNumber, 0, 0, 0, req->varName);
       notify_state_update(sys); // Notify GUI it needs input
     }
     else
     {
       // No callback registered - cannot get input. Terminate process.
-      sim_log(sys, "Error in P%d: 'assign input' used, but no input callback registered. Terminating.", pcb->programNumber);
+      sim_log(sys, SIM_LOG_IO, SIM_LOG_ERROR, "Error in P%d: 'assign input' used, but no input callback registered. Terminating.", pcb->programNumber);
       pcb->state = TERMINATED;
     }
   }
@@ -792,26 +2327,42 @@ static void do_assign(SystemState *sys, int pid, char *varName, char *valueOrSou
   }
 }
 
+// Mirrors the oldest pending input request into needsInput/inputPid/inputVarName
+static void syncPendingInput(SystemState *sys)
+{
+  sys->needsInput = sys->inputRequestCount > 0;
+  if (!sys->needsInput)
+  {
+    sys->inputPid = -1;
+    sys->inputVarName[0] = '\0';
+    return;
+  }
+  const InputRequest *req = &sys->inputRequests[sys->inputRequestHead];
+  sys->inputPid = req->pid;
+  memcpy(sys->inputVarName, req->varName, sizeof(sys->inputVarName));
+}
+
 // Called by GUI after obtaining input via request_input callback
 void provideInput(SystemState *sys, const char *input)
 {
   if (!sys->needsInput || sys->inputPid < 0)
   {
-    sim_log(sys, "Warning: provideInput called when no input was pending.");
+    sim_log(sys, SIM_LOG_IO, SIM_LOG_WARN, "Warning: provideInput called when no input was pending.");
     return;
   }
 
   PCB *pcb = findPCB(sys, sys->inputPid);
-  if (!pcb || pcb->state != RUNNING)
+  if (!pcb || pcb->state != BLOCKED || !pcb->inputWaiting)
   {
-    sim_log(sys, "Warning: provideInput called for P%d which is not in RUNNING state.", sys->inputPid);
-    // Clear the flag anyway
-    sys->needsInput = false;
-    sys->inputPid = -1;
+    sim_log(sys, SIM_LOG_IO, SIM_LOG_WARN, "Warning: provideInput called for P%d which is not waiting for input.", sys->inputPid);
+    // Drop the request anyway
+    sys->inputRequestHead = (sys->inputRequestHead + 1) % MAX_PROCESSES;
+    sys->inputRequestCount--;
+    syncPendingInput(sys);
     return;
   }
 
-  sim_log(sys, "P%d received input '%s' for variable '%s'", sys->inputPid, input ? input : "<NULL>", sys->inputVarName);
+  sim_log(sys, SIM_LOG_IO, SIM_LOG_INFO, "P%d received input '%s' for variable '%s'", pcb->programNumber, input ? input : "<NULL>", sys->inputVarName);
 
   if (input)
   {
@@ -820,33 +2371,52 @@ void provideInput(SystemState *sys, const char *input)
   else
   {
     // Handle case where input was cancelled or failed (e.g., treat as empty string or error?)
-    sim_log(sys, "P%d received NULL input for '%s'. Treating as empty string.", sys->inputPid, sys->inputVarName);
+    sim_log(sys, SIM_LOG_IO, SIM_LOG_WARN, "P%d received NULL input for '%s'. Treating as empty string.", pcb->programNumber, sys->inputVarName);
     setVariable(sys, sys->inputPid, sys->inputVarName, "");
   }
 
-  // Clear the input request flag
-  sys->needsInput = false;
-  sys->inputPid = -1;
-  sys->inputVarName[0] = '\0';
-
-  // If the process was waiting for input, it can now proceed.
-  // The next call to stepSimulation will likely execute the next instruction.
-  // We might need to potentially put it back in ready queue if context switched?
-  // However, the current design keeps it RUNNING but stalled on needsInput.
-  // Let's advance the PC here since the 'assign input' instruction is now complete.
-  if (pcb->state == RUNNING)
-  { // Double check it wasn't terminated by setVariable
-    pcb->programCounter++;
-    // Check for program completion immediately after input
-    int instCount = findInstructionCount(sys, pcb->processID);
-    if (pcb->programCounter >= instCount)
-    {
-      sim_log(sys, "P%d finished program after receiving input (PC=%d, InstCount=%d). Terminating.", pcb->programNumber, pcb->programCounter, instCount);
-      pcb->state = TERMINATED;
-    }
+  // Retire the request; the next one (if any) becomes sys->inputPid
+  sys->inputRequestHead = (sys->inputRequestHead + 1) % MAX_PROCESSES;
+  sys->inputRequestCount--;
+  syncPendingInput(sys);
+  pcb->inputWaiting = false;
+  pcb->blockedCycles[RESOURCE_USER_INPUT] += sys->clockCycle - pcb->blockedSince;
+
+  // The 'assign input' instruction is now complete
+  if (pcb->state == BLOCKED) // Double check it wasn't terminated by setVariable
+    finishBlockedInstruction(sys, pcb, SIM_EV_INPUT_DONE, 0);
+  else if (pcb->state == TERMINATED)
+    releaseHeldLocks(sys, pcb->processID);
+
+  notify_state_update(sys); // State changed (variable set)
+}
+
+// Completes the instruction a process blocked in for input or the disk, between cycles: advances
+// the PC and makes the process ready again, or terminates it after its last instruction.
+// `done` is recorded with b = 1 if the program finished and the given c.
+static void finishBlockedInstruction(SystemState *sys, PCB *pcb, SimEventKind done, int c)
+{
+  pcb->programCounter++;
+  if (pcb->programCounter >= findInstructionCount(sys, pcb->processID))
+  {
+    pcb->state = TERMINATED;
+    pcb->completionTime = sys->clockCycle;
+    latencyRecord(&sys->waitingHistogram, pcb->waitingTime);
+    releaseHeldLocks(sys, pcb->processID);
+    sys->fs.ioLogCount = 0; // The instruction's own blocks were already submitted
+    fsFlushOnExit(sys);
+    sim_event(sys, done, pcb->processID, pcb->programNumber, 1, c, 0, NULL);
+  }
+  else
+  {
+    pcb->state = READY;
+    if (sys->schedulerType == SIM_SCHED_MLFQ)
+      addToMLFQ(sys, pcb->processID, pcb->mlfqLevel); // Keeps its level: I/O-bound jobs stay on top
+    else
+      addToReadyQueue(sys, pcb->processID);
+    pcb->readySince = sys->clockCycle;
+    sim_event(sys, done, pcb->processID, pcb->programNumber, 0, c, 0, NULL);
   }
-
-  notify_state_update(sys); // State changed (variable set)
 }
 
 static void do_writeFile(SystemState *sys, int pid, char *fileVar, char *dataVar)
@@ -867,17 +2437,13 @@ static void do_writeFile(SystemState *sys, int pid, char *fileVar, char *dataVar
     return;
   }
 
-  FILE *f = fopen(filename, "w");
-  if (!f)
+  if (!fsWriteFile(sys, filename, data, strlen(data)))
   {
-    sim_log(sys, "Error in P%d: Cannot open file '%s' for writing: %s. Terminating.", pcb->programNumber, filename, strerror(errno));
+    sim_log(sys, SIM_LOG_IO, SIM_LOG_ERROR, "Error in P%d: Cannot write file '%s' (bad path or filesystem full). Terminating.", pcb->programNumber, filename);
     pcb->state = TERMINATED;
     return;
   }
-
-  fprintf(f, "%s", data);
-  fclose(f);
-  sim_log(sys, "P%d wrote to file '%s'", pcb->programNumber, filename);
+  sim_log(sys, SIM_LOG_IO, SIM_LOG_INFO, "P%d wrote to file '%s'", pcb->programNumber, filename);
 }
 
 static void do_readFile(SystemState *sys, int pid, char *fileVar)
@@ -892,34 +2458,18 @@ static void do_readFile(SystemState *sys, int pid, char *fileVar)
     return;
   }
 
-  FILE *f = fopen(filename, "r");
-  if (!f)
+  char content[500]; // Buffer to hold file content
+  int len = fsReadFile(sys, filename, content, sizeof(content));
+  if (len < 0)
   {
-    sim_log(sys, "Error in P%d: Cannot open file '%s' for reading: %s. Terminating.", pcb->programNumber, filename, strerror(errno));
+    sim_log(sys, SIM_LOG_IO, SIM_LOG_ERROR, "Error in P%d: Cannot open file '%s' for reading: no such file. Terminating.", pcb->programNumber, filename);
     pcb->state = TERMINATED;
     return;
   }
-
-  char content[500] = ""; // Buffer to hold file content
-  char lineBuffer[MAX_LINE_LENGTH];
-  size_t currentLen = 0;
-  size_t maxLen = sizeof(content) - 1; // Leave space for null terminator
-
-  while (fgets(lineBuffer, sizeof(lineBuffer), f))
+  if ((size_t)len >= sizeof(content))
   {
-    size_t lineLen = strlen(lineBuffer);
-    if (currentLen + lineLen > maxLen)
-    {
-      sim_log(sys, "Warning in P%d: File '%s' content truncated during read.", pcb->programNumber, filename);
-      strncat(content, lineBuffer, maxLen - currentLen);
-      currentLen = maxLen;
-      break; // Stop reading
-    }
-    strcat(content, lineBuffer);
-    currentLen += lineLen;
+    sim_log(sys, SIM_LOG_IO, SIM_LOG_WARN, "Warning in P%d: File '%s' content truncated during read.", pcb->programNumber, filename);
   }
-  fclose(f);
-  content[currentLen] = '\0'; // Ensure null termination
 
   // Store the content in a variable named "file_<originalVarName>"
   char resultVarName[100]; // Ensure large enough buffer
@@ -927,7 +2477,7 @@ static void do_readFile(SystemState *sys, int pid, char *fileVar)
 
   setVariable(sys, pid, resultVarName, content);
   // Log message happens in setVariable if successful, or error reported if fails
-  // sim_log(sys, "P%d read from '%s' into variable '%s'", pid, filename, resultVarName);
+  // sim_log(sys, SIM_LOG_IO, SIM_LOG_DEBUG, "P%d read from '%s' into variable '%s'", pid, filename, resultVarName);
 }
 
 static void do_printFromTo(SystemState *sys, int pid, char *v1, char *v2)
@@ -951,7 +2501,7 @@ static void do_printFromTo(SystemState *sys, int pid, char *v1, char *v2)
   // Basic check if conversion was successful (doesn't catch all errors)
   if (*endptr1 != '\0' || *endptr2 != '\0')
   {
-    sim_log(sys, "Error in P%d: printFromTo requires numeric values for '%s' ('%s') and '%s' ('%s').", pcb->programNumber, v1, s1, v2, s2);
+    sim_log(sys, SIM_LOG_INTERP, SIM_LOG_ERROR, "Error in P%d: printFromTo requires numeric values for '%s' ('%s') and '%s' ('%s').", pcb->programNumber, v1, s1, v2, s2);
     findPCB(sys, pid)->state = TERMINATED;
     return;
   }
@@ -968,7 +2518,7 @@ static void do_printFromTo(SystemState *sys, int pid, char *v1, char *v2)
       int written = snprintf(outputBuffer + strlen(outputBuffer), remaining, "%ld ", i);
       if (written < 0 || written >= remaining)
       {
-        sim_log(sys, "Warning in P%d: printFromTo output truncated.", pcb->programNumber);
+        sim_log(sys, SIM_LOG_IO, SIM_LOG_WARN, "Warning in P%d: printFromTo output truncated.", pcb->programNumber);
         break;
       }
       remaining -= written;
@@ -981,7 +2531,7 @@ static void do_printFromTo(SystemState *sys, int pid, char *v1, char *v2)
       int written = snprintf(outputBuffer + strlen(outputBuffer), remaining, "%ld ", i);
       if (written < 0 || written >= remaining)
       {
-        sim_log(sys, "Warning in P%d: printFromTo output truncated.", pcb->programNumber);
+        sim_log(sys, SIM_LOG_IO, SIM_LOG_WARN, "Warning in P%d: printFromTo output truncated.", pcb->programNumber);
         break;
       }
       remaining -= written;
@@ -1059,7 +2609,7 @@ static int dequeueMutexBlocked(SystemState *sys, Mutex *m)
   // If no suitable process found (shouldn't happen if size > 0 and PCBs exist)
   if (bestPid == -1)
   {
-    sim_log(sys, "Error: Could not find highest priority process in mutex queue (size %d)", m->size);
+    sim_log(sys, SIM_LOG_SYNC, SIM_LOG_ERROR, "Error: Could not find highest priority process in mutex queue (size %d)", m->size);
     // As a fallback, dequeue the head (FIFO)
     bestPid = m->blockedQueue[m->head];
     m->head = (m->head + 1) % MAX_QUEUE_SIZE;
@@ -1115,7 +2665,7 @@ static void blockProcess(SystemState *sys, int pid, ResourceType r)
 
   if (!enqueueMutexBlocked(m, pid))
   {
-    sim_log(sys, "Error: Mutex queue for resource %d full. Cannot block P%d. Terminating.", r, pcb->programNumber);
+    sim_log(sys, SIM_LOG_SYNC, SIM_LOG_ERROR, "Error: Mutex queue for resource %d full. Cannot block P%d. Terminating.", r, pcb->programNumber);
     pcb->state = TERMINATED;
     // Ensure the currently running process is cleared if it's the one terminating
     if (sys->runningProcessID == pid)
@@ -1127,6 +2677,7 @@ static void blockProcess(SystemState *sys, int pid, ResourceType r)
 
   pcb->state = BLOCKED;
   pcb->blockedOnResource = r;
+  pcb->blockedSince = sys->clockCycle;
 
   // If the currently running process is the one being blocked, CPU becomes idle
   if (sys->runningProcessID == pid)
@@ -1134,7 +2685,7 @@ static void blockProcess(SystemState *sys, int pid, ResourceType r)
     sys->runningProcessID = -1;
   }
 
-  sim_log(sys, "P%d BLOCKED on resource %d", pcb->programNumber, r);
+  sim_event(sys, SIM_EV_BLOCKED, pid, pcb->programNumber, r, 0, 0, NULL);
   notify_state_update(sys); // State changed
 }
 
@@ -1151,19 +2702,23 @@ static void unblockProcess(SystemState *sys, ResourceType r)
 
   if (pidToUnblock < 0)
   {
-    sim_log(sys, "Error: Mutex %d queue not empty but dequeue failed.", r);
+    sim_log(sys, SIM_LOG_SYNC, SIM_LOG_ERROR, "Error: Mutex %d queue not empty but dequeue failed.", r);
     return;
   }
 
   PCB *pcb = findPCB(sys, pidToUnblock);
   if (!pcb)
   {
-    sim_log(sys, "Error: Dequeued PID %d from mutex %d but PCB not found.", pidToUnblock, r);
+    sim_log(sys, SIM_LOG_SYNC, SIM_LOG_ERROR, "Error: Dequeued PID %d from mutex %d but PCB not found.", pidToUnblock, r);
     return;
   }
 
   pcb->state = READY;
   pcb->blockedOnResource = (ResourceType)-1; // Mark as not blocked
+  pcb->blockedCycles[r] += sys->clockCycle - pcb->blockedSince;
+  LineProfile *lp = lineProfileAt(sys, pcb);
+  if (lp)
+    lp->blocked += sys->clockCycle - pcb->blockedSince;
 
   // Mark this process as unblocked this cycle
   sys->wasUnblockedThisCycle[pidToUnblock] = true;
@@ -1177,8 +2732,9 @@ static void unblockProcess(SystemState *sys, ResourceType r)
   {
     addToReadyQueue(sys, pidToUnblock);
   }
+  pcb->readySince = sys->clockCycle + 1; // Woken while the current cycle executes: ready from the next one
 
-  sim_log(sys, "P%d UNBLOCKED from resource %d, added to ready queue.", pcb->programNumber, r);
+  sim_event(sys, SIM_EV_UNBLOCKED, pidToUnblock, pcb->programNumber, r, 0, 0, NULL);
   notify_state_update(sys);
 }
 
@@ -1191,29 +2747,127 @@ static void do_semWait(SystemState *sys, int pid, char *resName)
   ResourceType r = getResourceTypeFromString(resName);
   if (r < 0 || r >= NUM_RESOURCES)
   {
-    sim_log(sys, "Error in P%d: semWait invalid resource name '%s'. Terminating.", pcb->programNumber, resName ? resName : "<null>");
+    sim_log(sys, SIM_LOG_SYNC, SIM_LOG_ERROR, "Error in P%d: semWait invalid resource name '%s'. Terminating.", pcb->programNumber, resName ? resName : "<null>");
     pcb->state = TERMINATED;
     return;
   }
 
+  acquireResource(sys, pid, r);
+}
+
+// ------------- Lock Contention -------------
+
+// Counts a block at the line pcb is executing
+static void recordBlockSite(SystemState *sys, const PCB *pcb, ResourceType r)
+{
+  for (int i = 0; i < sys->blockSiteCount; i++)
+  {
+    BlockSite *site = &sys->blockSites[i];
+    if (site->programNumber == pcb->programNumber && site->line == pcb->programCounter && site->resource == r)
+    {
+      site->count++;
+      return;
+    }
+  }
+  if (sys->blockSiteCount == MAX_BLOCK_SITES)
+  {
+    sys->blockSitesDropped++;
+    return;
+  }
+  BlockSite *site = &sys->blockSites[sys->blockSiteCount++];
+  site->programNumber = pcb->programNumber;
+  site->line = pcb->programCounter;
+  site->resource = r;
+  site->count = 1;
+}
+
+static int compareBlockSites(const void *a, const void *b)
+{
+  long ca = ((const BlockSite *)a)->count, cb = ((const BlockSite *)b)->count;
+  return (cb > ca) - (cb < ca);
+}
+
+int getTopBlockSites(const SystemState *sys, BlockSite *out, int max)
+{
+  BlockSite sorted[MAX_BLOCK_SITES];
+  memcpy(sorted, sys->blockSites, sizeof(BlockSite) * sys->blockSiteCount);
+  qsort(sorted, sys->blockSiteCount, sizeof(BlockSite), compareBlockSites);
+  int n = sys->blockSiteCount < max ? sys->blockSiteCount : max;
+  memcpy(out, sorted, sizeof(BlockSite) * (n > 0 ? n : 0));
+  return n > 0 ? n : 0;
+}
+
+// Takes resource r for pid, or blocks pid on it. Returns true if acquired.
+static bool acquireResource(SystemState *sys, int pid, ResourceType r)
+{
+  PCB *pcb = &sys->processTable[pid];
   Mutex *m = &sys->mutexes[r];
 
   if (m->locked)
   {
-    sim_log(sys, "P%d requests locked resource %d. Blocking.", pcb->programNumber, r);
+    sim_event(sys, SIM_EV_LOCK_WAIT, pid, pcb->programNumber, r, 0, 0, NULL);
+    if (!pcb->lockWaiting)
+    {
+      pcb->lockWaiting = true; // A woken process can lose the lock again; wait from the first request
+      pcb->lockWaitSince = sys->clockCycle;
+    }
+    recordBlockSite(sys, pcb, r);
     // Associate priority with the process *before* blocking (MLFQ level)
     pcb->priority = (sys->schedulerType == SIM_SCHED_MLFQ) ? pcb->mlfqLevel : 0;
     blockProcess(sys, pid, r);
     // blockProcess sets runningProcessID to -1 if needed and notifies GUI
+    return false;
   }
-  else
+  m->locked = true;
+  m->lockingProcessID = pid;
+  LockStats *st = &m->stats;
+  st->acquisitions++;
+  if (pcb->lockWaiting)
+    st->contended++;
+  latencyRecord(&st->wait, pcb->lockWaiting ? sys->clockCycle - pcb->lockWaitSince : 0);
+  pcb->lockWaiting = false;
+  st->heldSince = sys->clockCycle;
+  sim_event(sys, SIM_EV_ACQUIRED, pid, pcb->programNumber, r, 0, 0, NULL);
+  // Process continues, PC will advance normally
+  notify_state_update(sys); // State changed (mutex locked)
+  return true;
+}
+
+// Releases resource r if pid holds it and wakes the highest-priority waiter.
+// Returns false (changing nothing) if pid does not hold r.
+static bool releaseResource(SystemState *sys, int pid, ResourceType r)
+{
+  Mutex *m = &sys->mutexes[r];
+  if (!m->locked || m->lockingProcessID != pid)
+  {
+    return false;
+  }
+  m->locked = false;
+  m->lockingProcessID = -1;
+  int hold = sys->clockCycle - m->stats.heldSince;
+  m->stats.holdTotal += hold;
+  if (hold > m->stats.holdMax)
+    m->stats.holdMax = hold;
+  sim_event(sys, SIM_EV_RELEASED, pid, sys->processTable[pid].programNumber, r, 0, 0, NULL);
+  // Now unblock the highest priority waiting process, if any
+  unblockProcess(sys, r); // unblockProcess handles adding to ready queue & notify
+  return true;
+}
+
+// A process that terminates (normally or on an error) inside a semWait/semSignal section
+// would otherwise keep the lock forever, leaving its waiters blocked and its slot unrecyclable
+static void releaseHeldLocks(SystemState *sys, int pid)
+{
+  for (int r = 0; r < NUM_RESOURCES; r++)
   {
-    m->locked = true;
-    m->lockingProcessID = pid;
-    sim_log(sys, "P%d acquired resource %d.", pcb->programNumber, r);
-    // Process continues, PC will advance normally
-    notify_state_update(sys); // State changed (mutex locked)
+    if (sys->mutexes[r].locked && sys->mutexes[r].lockingProcessID == pid)
+    {
+      sim_log(sys, SIM_LOG_SYNC, SIM_LOG_WARN, "Warning: P%d terminated holding resource %d; releasing it.",
+              sys->processTable[pid].programNumber, r);
+      releaseResource(sys, pid, (ResourceType)r);
+    }
   }
+  sys->processTable[pid].burstHolding = false;
 }
 
 static void do_semSignal(SystemState *sys, int pid, char *resName)
@@ -1225,25 +2879,17 @@ static void do_semSignal(SystemState *sys, int pid, char *resName)
   ResourceType r = getResourceTypeFromString(resName);
   if (r < 0 || r >= NUM_RESOURCES)
   {
-    sim_log(sys, "Error in P%d: semSignal invalid resource name '%s'. Terminating.", pcb->programNumber, resName ? resName : "<null>");
+    sim_log(sys, SIM_LOG_SYNC, SIM_LOG_ERROR, "Error in P%d: semSignal invalid resource name '%s'. Terminating.", pcb->programNumber, resName ? resName : "<null>");
     pcb->state = TERMINATED;
     return;
   }
 
   Mutex *m = &sys->mutexes[r];
 
-  if (m->locked && m->lockingProcessID == pid)
-  {
-    m->locked = false;
-    m->lockingProcessID = -1;
-    sim_log(sys, "P%d released resource %d.", pcb->programNumber, r);
-    // Now unblock the highest priority waiting process, if any
-    unblockProcess(sys, r); // unblockProcess handles adding to ready queue & notify
-  }
-  else
+  if (!releaseResource(sys, pid, r))
   {
     // Trying to signal a resource not held or not locked
-    sim_log(sys, "Error in P%d: Illegal semSignal on resource %d (Locked: %d, Holder: P%d). Terminating.",
+    sim_log(sys, SIM_LOG_SYNC, SIM_LOG_ERROR, "Error in P%d: Illegal semSignal on resource %d (Locked: %d, Holder: P%d). Terminating.",
             pcb->programNumber, r, m->locked, m->lockingProcessID);
     pcb->state = TERMINATED;
   }
@@ -1255,10 +2901,311 @@ static void do_semSignal(SystemState *sys, int pid, char *resName)
   }
 }
 
+// ------ Burst-Model Processes ------
+
+// One cycle of a burst-model process. A phase's resource is acquired on its first cycle
+// (blocking like semWait while another process holds it) and released after its last.
+static void executeBurstCycle(SystemState *sys, int pid)
+{
+  PCB *pcb = &sys->processTable[pid];
+  if (pcb->programCounter >= pcb->burstCount)
+  {
+    pcb->state = TERMINATED;
+    return;
+  }
+  BurstPhase *phase = &pcb->bursts[pcb->programCounter];
+  if (phase->resource != (ResourceType)-1 && !pcb->burstHolding)
+  {
+    if (!acquireResource(sys, pid, phase->resource))
+    {
+      return; // Blocked; the phase is retried once the resource is released
+    }
+    pcb->burstHolding = true;
+  }
+
+  sim_event(sys, SIM_EV_BURST, pid, pcb->programNumber, pcb->programCounter + 1, pcb->burstCount,
+            pcb->burstRemaining, NULL);
+  sys->instructionsExecuted++;
+  if (--pcb->burstRemaining > 0)
+  {
+    return;
+  }
+
+  if (pcb->burstHolding)
+  {
+    releaseResource(sys, pid, phase->resource);
+    pcb->burstHolding = false;
+  }
+  pcb->programCounter++;
+  if (pcb->programCounter >= pcb->burstCount)
+  {
+    sim_event(sys, SIM_EV_BURST_END, pid, pcb->programNumber, 0, 0, 0, NULL);
+    pcb->state = TERMINATED;
+  }
+  else
+  {
+    pcb->burstRemaining = pcb->bursts[pcb->programCounter].cycles;
+  }
+}
+
+static LoadStatus loadBurstIntoSlot(SystemState *sys, const BurstPhase *phases, int count, int arrivalTime, int slot,
+                                    int programNumber)
+{
+  if (count < 1 || count > MAX_BURSTS)
+  {
+    sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error: a burst process needs 1 to %d phases, got %d.", MAX_BURSTS, count);
+    return LOAD_FAILED;
+  }
+  for (int i = 0; i < count; i++)
+  {
+    bool validResource = phases[i].resource == (ResourceType)-1 || (unsigned)phases[i].resource < NUM_RESOURCES;
+    if (phases[i].cycles < 1 || !validResource)
+    {
+      sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error: invalid burst phase %d (cycles %d, resource %d).", i, phases[i].cycles, (int)phases[i].resource);
+      return LOAD_FAILED;
+    }
+  }
+
+  PCB *pcb = &sys->processTable[slot];
+  memset(pcb, 0, sizeof(*pcb));
+  pcb->processID = slot;
+  pcb->programNumber = programNumber;
+  pcb->kind = PROCESS_BURST;
+  pcb->state = NEW;
+  pcb->memoryLowerBound = 0; // Empty segment: a burst process owns no memory words
+  pcb->memoryUpperBound = -1;
+  pcb->arrivalTime = arrivalTime;
+  pcb->blockedOnResource = (ResourceType)-1;
+  pcb->firstRunTime = -1;
+  pcb->completionTime = -1;
+  pcb->readySince = arrivalTime;
+  memcpy(pcb->bursts, phases, sizeof(BurstPhase) * count);
+  pcb->burstCount = count;
+  pcb->burstRemaining = phases[0].cycles;
+
+  if (sim_event_enabled(sys, SIM_EV_LOADED))
+  {
+    char message[128];
+    snprintf(message, sizeof(message), "Loaded burst P%d: phases=%d, arrival=%d", pcb->programNumber, count,
+             pcb->arrivalTime);
+    sim_event_emit(sys, SIM_EV_LOADED, slot, pcb->programNumber, pcb->arrivalTime, 0, 0, message);
+  }
+  if (slot == sys->processCount)
+  {
+    sys->processCount++;
+  }
+  notify_state_update(sys);
+  return LOAD_OK;
+}
+
+bool loadBurstProcessAt(SystemState *sys, const BurstPhase *phases, int count, int arrivalTime, int programNumber)
+{
+  if (sys->processCount >= MAX_PROCESSES)
+  {
+    sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error: process table full, cannot load burst process P%d", programNumber);
+    return false;
+  }
+  return loadBurstIntoSlot(sys, phases, count, arrivalTime < sys->clockCycle ? sys->clockCycle : arrivalTime,
+                           sys->processCount, programNumber) == LOAD_OK;
+}
+
+// Parses "cpu 5 file 3 cpu 2" into phases; returns the phase count or -1
+static int parseBurstPhases(const char *spec, BurstPhase *phases)
+{
+  char buf[256];
+  snprintf(buf, sizeof(buf), "%s", spec);
+  char *save = NULL;
+  int count = 0;
+  for (char *name = strtok_r(buf, " \t", &save); name; name = strtok_r(NULL, " \t", &save))
+  {
+    char *cycles = strtok_r(NULL, " \t", &save);
+    if (!cycles || count >= MAX_BURSTS)
+      return -1;
+    phases[count].cycles = atoi(cycles);
+    phases[count].resource = strcmp(name, "cpu") == 0 ? (ResourceType)-1 : getResourceTypeFromString(name);
+    if (strcmp(name, "cpu") != 0 && phases[count].resource == (ResourceType)-1)
+      return -1;
+    count++;
+  }
+  return count;
+}
+
+// ------ Workload Trace ------
+
+// Reads the next valid entry into sys->trace; clears `pending` at end of file or on a bad line
+static void readNextTraceEntry(SystemState *sys)
+{
+  WorkloadTrace *t = &sys->trace;
+  t->pending = false;
+  t->deferLogged = false;
+  char line[MAX_LINE_LENGTH + 300];
+  while (t->file && fgets(line, sizeof(line), t->file))
+  {
+    t->line++;
+    char *hash = strchr(line, '#');
+    if (hash)
+      *hash = '\0';
+    line[strcspn(line, "\r\n")] = '\0';
+    char *p = line + strspn(line, " \t");
+    if (*p == '\0')
+      continue; // Blank or comment
+    int arrival;
+    int consumed = 0;
+    char *rest = NULL;
+    if (sscanf(p, "%d%n", &arrival, &consumed) == 1 && arrival >= 0)
+    {
+      rest = p + consumed + strspn(p + consumed, " \t");
+    }
+    if (!rest || *rest == '\0' || strlen(rest) >= sizeof(t->program))
+    {
+      sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error: trace line %d is not '<arrival> <program>', ignoring the rest of the trace.", t->line);
+      return;
+    }
+    snprintf(t->program, sizeof(t->program), "%s", rest);
+    t->arrivalTime = arrival;
+    t->pending = true;
+    return;
+  }
+}
+
+bool openWorkloadTrace(SystemState *sys, const char *path)
+{
+  closeWorkloadTrace(sys);
+  WorkloadTrace *t = &sys->trace;
+  t->file = fopen(path, "r");
+  if (!t->file)
+  {
+    sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error opening trace '%s': %s", path, strerror(errno));
+    return false;
+  }
+  const char *slash = strrchr(path, '/');
+  int dirLen = slash ? (int)(slash - path + 1) : 0;
+  snprintf(t->dir, sizeof(t->dir), "%.*s", dirLen, path);
+  t->line = t->admitted = t->skipped = 0;
+  sys->simulationComplete = false;
+  readNextTraceEntry(sys);
+  return true;
+}
+
+void closeWorkloadTrace(SystemState *sys)
+{
+  if (sys->trace.file)
+  {
+    fclose(sys->trace.file);
+  }
+  sys->trace.file = NULL;
+  sys->trace.pending = false;
+}
+
+// Releases the memory and table slot of one terminated process, folding its metrics
+// into sys->retired. Returns false if no terminated process can be vacated.
+static bool vacateTerminatedSlot(SystemState *sys)
+{
+  for (int i = 0; i < sys->processCount; i++)
+  {
+    PCB *pcb = &sys->processTable[i];
+    if (pcb->state != TERMINATED || pcb->memoryLowerBound < 0)
+      continue;
+    releaseHeldLocks(sys, i); // Normally done at termination; the lock owner must not outlive the slot
+
+    int finish = pcb->completionTime >= 0 ? pcb->completionTime : sys->clockCycle;
+    int start = pcb->firstRunTime >= 0 ? pcb->firstRunTime : finish;
+    sys->retired.count++;
+    sys->retired.turnaround += finish - pcb->arrivalTime;
+    sys->retired.response += start - pcb->arrivalTime;
+    sys->retired.waiting += pcb->waitingTime;
+    sys->retired.cpuCycles += pcb->cpuCycles;
+    for (int r = 0; r < NUM_RESOURCES; r++)
+      sys->retired.blocked += pcb->blockedCycles[r];
+    sys->retired.blocked += pcb->diskCycles;
+    sys->retired.contextSwitches += pcb->contextSwitches;
+    sys->retired.preemptions += pcb->preemptions;
+
+    for (int m = pcb->memoryLowerBound; m <= pcb->memoryUpperBound; m++)
+    {
+      sys->memory[m].name[0] = '\0';
+      sys->memory[m].value[0] = '\0';
+    }
+    pcb->memoryLowerBound = pcb->memoryUpperBound = -1;
+    if (sys->lastDispatchedPid == i)
+    {
+      sys->lastDispatchedPid = -2; // Whatever runs next is a different process
+    }
+    return true;
+  }
+  return false;
+}
+
+// Loads trace entries whose arrival cycle has come, in trace order. An entry that does not
+// fit yet stays pending (holding back the ones after it) until a process terminates.
+static void admitTraceArrivals(SystemState *sys)
+{
+  WorkloadTrace *t = &sys->trace;
+  while (t->pending && t->arrivalTime <= sys->clockCycle)
+  {
+    // "burst <phases>" entries need no file; anything else names a program file
+    bool burst = strncmp(t->program, "burst", 5) == 0 && (t->program[5] == ' ' || t->program[5] == '\t');
+    BurstPhase phases[MAX_BURSTS];
+    int phaseCount = burst ? parseBurstPhases(t->program + 6, phases) : 0;
+    char path[sizeof(t->dir) + sizeof(t->program)];
+    int nameLen = (int)strcspn(t->program, " \t");
+    if (t->program[0] == '/')
+      snprintf(path, sizeof(path), "%.*s", nameLen, t->program);
+    else
+      snprintf(path, sizeof(path), "%s%.*s", t->dir, nameLen, t->program);
+
+    LoadStatus status = LOAD_NO_MEMORY;
+    for (;;)
+    {
+      int slot = sys->processCount < MAX_PROCESSES ? sys->processCount : -1;
+      for (int i = 0; slot < 0 && i < sys->processCount; i++)
+      {
+        if (sys->processTable[i].state == TERMINATED && sys->processTable[i].memoryLowerBound < 0)
+          slot = i;
+      }
+      if (slot >= 0)
+      {
+        status = burst ? loadBurstIntoSlot(sys, phases, phaseCount, t->arrivalTime, slot, t->line)
+                       : loadProgramIntoSlot(sys, path, t->arrivalTime, slot);
+        if (status != LOAD_NO_MEMORY)
+          break;
+      }
+      if (!vacateTerminatedSlot(sys))
+        break;
+    }
+
+    bool live = false;
+    for (int i = 0; !live && i < sys->processCount; i++)
+      live = sys->processTable[i].state != TERMINATED;
+    if (status == LOAD_NO_MEMORY && !live)
+    {
+      // Everything is vacated and it still does not fit: waiting would never end
+      sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_ERROR, "Error: %s skipped, it does not fit in free memory.", t->program);
+      status = LOAD_FAILED;
+    }
+    else if (status == LOAD_NO_MEMORY)
+    {
+      if (!t->deferLogged)
+      {
+        sim_log(sys, SIM_LOG_MEMORY, SIM_LOG_WARN, "Clock %d: %s deferred, no free process slot or memory.", sys->clockCycle, t->program);
+        t->deferLogged = true;
+      }
+      return;
+    }
+    if (status == LOAD_OK)
+      t->admitted++;
+    else
+      t->skipped++;
+    readNextTraceEntry(sys);
+  }
+}
+
 // ------ Arrival Check ------
 
 static void checkArrivals(SystemState *sys)
 {
+  admitTraceArrivals(sys);
+
   // First, handle any processes that were unblocked this cycle
   for (int i = 0; i < sys->processCount; i++)
   {
@@ -1279,7 +3226,7 @@ static void checkArrivals(SystemState *sys)
     PCB *pcb = &sys->processTable[i];
     if (pcb->state == NEW && pcb->arrivalTime <= sys->clockCycle)
     {
-      sim_log(sys, "Clock %d: P%d arrived.", sys->clockCycle, pcb->programNumber);
+      sim_event(sys, SIM_EV_ARRIVAL, i, pcb->programNumber, 0, 0, 0, NULL);
       pcb->state = READY;
       if (sys->schedulerType == SIM_SCHED_MLFQ)
       {
@@ -1289,26 +3236,260 @@ static void checkArrivals(SystemState *sys)
       {
         addToReadyQueue(sys, i);
       }
+      // Waiting starts at arrival: a trace entry held back for want of a slot or memory has
+      // been waiting for the CPU since then, not since its admission
+      pcb->readySince = pcb->arrivalTime;
       notify_state_update(sys);
     }
   }
 }
 
+// ------ Line Profile ------
+
+// Entry for the line pcb is at, created on first use; NULL (and counted as dropped) once full
+static LineProfile *lineProfileAt(SystemState *sys, const PCB *pcb)
+{
+  const unsigned mask = 2 * MAX_LINE_PROFILES - 1;
+  unsigned slot = ((unsigned)pcb->programNumber * 2654435761u + (unsigned)pcb->programCounter) & mask;
+  while (sys->lineProfileSlots[slot] != 0)
+  {
+    LineProfile *lp = &sys->lineProfiles[sys->lineProfileSlots[slot] - 1];
+    if (lp->programNumber == pcb->programNumber && lp->line == pcb->programCounter)
+      return lp;
+    slot = (slot + 1) & mask;
+  }
+  if (sys->lineProfileCount == MAX_LINE_PROFILES)
+  {
+    sys->lineProfileDropped++;
+    return NULL;
+  }
+  LineProfile *lp = &sys->lineProfiles[sys->lineProfileCount++];
+  lp->programNumber = pcb->programNumber;
+  lp->line = pcb->programCounter;
+  sys->lineProfileSlots[slot] = (unsigned short)sys->lineProfileCount;
+  return lp;
+}
+
+static int compareLineProfiles(const void *a, const void *b)
+{
+  const LineProfile *x = a, *y = b;
+  if (x->executed != y->executed)
+    return (y->executed > x->executed) - (y->executed < x->executed);
+  if (x->blocked != y->blocked)
+    return (y->blocked > x->blocked) - (y->blocked < x->blocked);
+  if (x->programNumber != y->programNumber)
+    return x->programNumber - y->programNumber;
+  return x->line - y->line;
+}
+
+int getLineProfile(const SystemState *sys, LineProfile *out, int max)
+{
+  LineProfile sorted[MAX_LINE_PROFILES];
+  memcpy(sorted, sys->lineProfiles, sizeof(LineProfile) * sys->lineProfileCount);
+  qsort(sorted, sys->lineProfileCount, sizeof(LineProfile), compareLineProfiles);
+  int n = sys->lineProfileCount < max ? sys->lineProfileCount : max;
+  memcpy(out, sorted, sizeof(LineProfile) * (n > 0 ? n : 0));
+  return n > 0 ? n : 0;
+}
+
+// ------ Latency Histograms ------
+
+static int latencyBucket(int value)
+{
+  if (value < LATENCY_SUB_COUNT)
+    return value < 0 ? 0 : value;
+  int exponent = 31 - __builtin_clz((unsigned)value); // >= LATENCY_SUB_BITS
+  int shift = exponent - LATENCY_SUB_BITS;
+  return (shift + 1) * LATENCY_SUB_COUNT + ((value >> shift) - LATENCY_SUB_COUNT);
+}
+
+// Largest value that falls into bucket
+static int latencyBucketTop(int bucket)
+{
+  if (bucket < LATENCY_SUB_COUNT)
+    return bucket;
+  int shift = bucket / LATENCY_SUB_COUNT - 1;
+  long top = ((long)(bucket % LATENCY_SUB_COUNT + LATENCY_SUB_COUNT + 1) << shift) - 1;
+  return top > 0x7fffffff ? 0x7fffffff : (int)top;
+}
+
+void latencyRecord(LatencyHistogram *h, int value)
+{
+  if (value < 0)
+    value = 0;
+  h->counts[latencyBucket(value)]++;
+  h->count++;
+  h->sum += value;
+  if (value > h->max)
+    h->max = value;
+}
+
+void latencyMerge(LatencyHistogram *into, const LatencyHistogram *from)
+{
+  for (int i = 0; i < LATENCY_BUCKETS; i++)
+    into->counts[i] += from->counts[i];
+  into->count += from->count;
+  into->sum += from->sum;
+  if (from->max > into->max)
+    into->max = from->max;
+}
+
+int latencyPercentile(const LatencyHistogram *h, double p)
+{
+  if (h->count == 0)
+    return 0;
+  long rank = (long)(p / 100.0 * h->count + 0.999999); // Nearest rank, rounded up
+  if (rank < 1)
+    rank = 1;
+  long seen = 0;
+  for (int i = 0; i < LATENCY_BUCKETS; i++)
+  {
+    seen += h->counts[i];
+    if (seen >= rank)
+    {
+      int top = latencyBucketTop(i);
+      return top < h->max ? top : h->max;
+    }
+  }
+  return h->max;
+}
+
+// ------ Process Metrics ------
+
+bool getProcessMetrics(const SystemState *sys, int pid, ProcessMetrics *out)
+{
+  if (pid < 0 || pid >= sys->processCount || sys->processTable[pid].memoryLowerBound < 0)
+  {
+    return false; // No process, or the slot was vacated for a streamed process
+  }
+  const PCB *pcb = &sys->processTable[pid];
+  memset(out, 0, sizeof(*out));
+  out->programNumber = pcb->programNumber;
+  out->state = pcb->state;
+  out->arrivalTime = pcb->arrivalTime;
+  out->firstRunTime = pcb->firstRunTime;
+  out->completionTime = pcb->completionTime;
+  out->responseTime = pcb->firstRunTime >= 0 ? pcb->firstRunTime - pcb->arrivalTime : -1;
+  out->turnaroundTime = pcb->completionTime >= 0 ? pcb->completionTime - pcb->arrivalTime : -1;
+  out->cpuCycles = pcb->cpuCycles;
+  out->contextSwitches = pcb->contextSwitches;
+  out->preemptions = pcb->preemptions;
+
+  // Time accumulates when a state is left; add the current stint
+  out->waitingTime = pcb->waitingTime;
+  if (pcb->state == READY)
+    out->waitingTime += sys->clockCycle - pcb->readySince;
+  for (int r = 0; r < NUM_RESOURCES; r++)
+  {
+    out->blockedCycles[r] = pcb->blockedCycles[r];
+    if (pcb->state == BLOCKED &&
+        (pcb->blockedOnResource == (ResourceType)r || (pcb->inputWaiting && r == RESOURCE_USER_INPUT)))
+      out->blockedCycles[r] += sys->clockCycle - pcb->blockedSince;
+    out->blockedTotal += out->blockedCycles[r];
+  }
+  out->diskCycles = pcb->diskCycles;
+  if (pcb->state == BLOCKED && pcb->diskWaiting && sys->clockCycle > pcb->blockedSince)
+    out->diskCycles += sys->clockCycle - pcb->blockedSince;
+  out->blockedTotal += out->diskCycles;
+  return true;
+}
+
+// One line per process still in the table; streamed processes already retired are summed
+static void logMetricsSummary(SystemState *sys)
+{
+  if (SIM_LOG_INFO > sys->logLevel[SIM_LOG_SCHED])
+    return;
+  ProcessMetrics m;
+  for (int i = 0; i < sys->processCount; i++)
+  {
+    if (!getProcessMetrics(sys, i, &m))
+      continue;
+    sim_log(sys, SIM_LOG_SCHED, SIM_LOG_INFO,
+            "P%d: turnaround %d, response %d, waiting %d, cpu %d, blocked %d (file %d, userInput %d, userOutput %d, "
+            "disk %d), switches %d, preemptions %d",
+            m.programNumber, m.turnaroundTime, m.responseTime, m.waitingTime, m.cpuCycles, m.blockedTotal,
+            m.blockedCycles[RESOURCE_FILE], m.blockedCycles[RESOURCE_USER_INPUT], m.blockedCycles[RESOURCE_USER_OUTPUT],
+            m.diskCycles, m.contextSwitches, m.preemptions);
+  }
+  const ProcessTotals *r = &sys->retired;
+  if (r->count > 0)
+  {
+    sim_log(sys, SIM_LOG_SCHED, SIM_LOG_INFO,
+            "%d retired processes: avg turnaround %.2f, response %.2f, waiting %.2f, cpu %.2f, blocked %.2f, "
+            "switches %ld, preemptions %ld",
+            r->count, (double)r->turnaround / r->count, (double)r->response / r->count, (double)r->waiting / r->count,
+            (double)r->cpuCycles / r->count, (double)r->blocked / r->count, r->contextSwitches, r->preemptions);
+  }
+}
+
+// ------ Host Profile ------
+
+bool hostProfileEnabled(void)
+{
+#ifdef MINISIM_HOST_PROFILE
+  return true;
+#else
+  return false;
+#endif
+}
+
+static int appendHostTimer(char *buf, size_t size, int len, const char *name, const HostTimer *t,
+                           unsigned long long stepNs)
+{
+  if (len < 0 || (size_t)len >= size || t->count == 0)
+    return len;
+  return len + snprintf(buf + len, size - len, "%-14s %10lu %12.3f %10.1f %6.1f%%\n", name, t->count, t->ns / 1e6,
+                        (double)t->ns / t->count, stepNs ? 100.0 * t->ns / stepNs : 0.0);
+}
+
+int formatHostProfile(const SystemState *sys, char *buf, size_t size)
+{
+  static const char *phaseNames[SIM_PHASE_COUNT] = {"arrivals", "quantum", "dispatch", "interpret", "callbacks"};
+  static const char *opNames[SIM_OP_COUNT] = {"nop",     "print",     "assign",  "writeFile", "readFile",
+                                              "printFromTo", "semWait", "semSignal", "unknown", "burst"};
+  const HostProfile *hp = &sys->hostProfile;
+  if (size == 0)
+    return 0;
+  buf[0] = '\0';
+  if (!hostProfileEnabled())
+    return snprintf(buf, size, "Host profiling not compiled in (build with HOST_PROFILE=1)\n");
+
+  int len = snprintf(buf, size, "%-14s %10s %12s %10s %7s\n", "Phase", "Calls", "Total ms", "ns/call", "Step");
+  len = appendHostTimer(buf, size, len, "step", &hp->step, hp->step.ns);
+  for (int p = 0; p < SIM_PHASE_COUNT; p++)
+    len = appendHostTimer(buf, size, len, phaseNames[p], &hp->phase[p], hp->step.ns);
+  if (len >= 0 && (size_t)len < size)
+    len += snprintf(buf + len, size - len, "%-14s %10s %12s %10s %7s\n", "Opcode", "Calls", "Total ms", "ns/call", "Step");
+  for (int o = 0; o < SIM_OP_COUNT; o++)
+    len = appendHostTimer(buf, size, len, opNames[o], &hp->opcode[o], hp->step.ns);
+  return len;
+}
+
 // ------ Simulation Step ------
 
 bool isSimulationComplete(SystemState *sys)
 {
-  // If no processes have been loaded, the simulation is not complete.
-  if (sys->processCount == 0)
+  // Trace entries still to come: not complete
+  if (sys->trace.pending)
   {
     return false;
   }
+  // No processes loaded yet: not complete, unless a trace ran out without loading any
+  if (sys->processCount == 0)
+  {
+    return sys->trace.file != NULL;
+  }
 
   // If already marked complete, return true
   if (sys->simulationComplete)
   {
     return true;
   }
+  // Write-backs queued at process exit still occupy the disk
+  if (sys->disk.busy || sys->disk.queued > 0)
+  {
+    return false;
+  }
 
   // Check if all loaded processes are terminated
   int completedOrTerminatedCount = 0;
@@ -1334,7 +3515,7 @@ void stepSimulation(SystemState *sys)
 {
   if (isSimulationComplete(sys))
   {
-    sim_log(sys, "Simulation already complete.");
+    sim_log(sys, SIM_LOG_SCHED, SIM_LOG_INFO, "Simulation already complete.");
     return;
   }
 
@@ -1344,17 +3525,15 @@ void stepSimulation(SystemState *sys)
     sys->wasUnblockedThisCycle[i] = false;
   }
 
-  // Check if waiting for input - if so, do nothing until input provided
-  if (sys->needsInput)
-  {
-    sim_log(sys, "Simulation paused, waiting for input for P%d.", sys->inputPid);
-    return;
-  }
-
-  sim_log(sys, "--- Clock Cycle %d ---", sys->clockCycle);
+  HOST_TIMER_BEGIN(stepStart);
+  HOST_PHASE(sys, SIM_PHASE_ARRIVALS);
+  sim_event(sys, SIM_EV_CYCLE, -1, 0, 0, 0, 0, NULL);
 
   // 1. Check for new arrivals and add them to ready queue(s)
   checkArrivals(sys);
+  diskTick(sys); // Processes whose requests finish can be dispatched this cycle
+
+  HOST_PHASE(sys, SIM_PHASE_QUANTUM);
 
   // 2. Check if the currently running process finished its quantum or execution
   bool needToSchedule = false;
@@ -1364,7 +3543,7 @@ void stepSimulation(SystemState *sys)
     if (!runningPCB || runningPCB->state != RUNNING)
     {
       // This case indicates an inconsistency, maybe the process got blocked/terminated externally?
-      sim_log(sys, "Warning: Running PID %d is not in RUNNING state (%d). CPU becoming idle.", sys->runningProcessID, runningPCB ? runningPCB->state : -1);
+      sim_log(sys, SIM_LOG_SCHED, SIM_LOG_WARN, "Warning: Running PID %d is not in RUNNING state (%d). CPU becoming idle.", sys->runningProcessID, runningPCB ? (int)runningPCB->state : -1);
       sys->runningProcessID = -1;
       needToSchedule = true;
     }
@@ -1373,7 +3552,8 @@ void stepSimulation(SystemState *sys)
       // Quantum handling for RR and MLFQ
       if (sys->schedulerType == SIM_SCHED_RR && runningPCB->quantumRemaining <= 0)
       {
-        sim_log(sys, "P%d RR quantum expired.", runningPCB->programNumber);
+        sim_event(sys, SIM_EV_RR_EXPIRED, sys->runningProcessID, runningPCB->programNumber, 0, 0, 0, NULL);
+        runningPCB->preemptions++;
         runningPCB->state = READY;
         addToReadyQueue(sys, sys->runningProcessID);
         sys->runningProcessID = -1;
@@ -1382,11 +3562,12 @@ void stepSimulation(SystemState *sys)
       }
       else if (sys->schedulerType == SIM_SCHED_MLFQ && runningPCB->quantumRemaining <= 0)
       {
-        sim_log(sys, "P%d MLFQ quantum expired at level %d.", runningPCB->programNumber, runningPCB->mlfqLevel);
+        sim_event(sys, SIM_EV_MLFQ_EXPIRED, sys->runningProcessID, runningPCB->programNumber, runningPCB->mlfqLevel, 0, 0, NULL);
+        runningPCB->preemptions++;
         runningPCB->state = READY;
         // Demote process: move to next lower level, or stay at lowest if already there
-        int nextLevel = (runningPCB->mlfqLevel < MLFQ_LEVELS - 1) ? runningPCB->mlfqLevel + 1 : runningPCB->mlfqLevel;
-        sim_log(sys, "P%d demoted to level %d.", runningPCB->programNumber, nextLevel);
+        int nextLevel = (runningPCB->mlfqLevel < sys->mlfqLevels - 1) ? runningPCB->mlfqLevel + 1 : runningPCB->mlfqLevel;
+        sim_event(sys, SIM_EV_DEMOTED, sys->runningProcessID, runningPCB->programNumber, nextLevel, 0, 0, NULL);
         addToMLFQ(sys, sys->runningProcessID, nextLevel);
         sys->runningProcessID = -1;
         needToSchedule = true;
@@ -1402,6 +3583,7 @@ void stepSimulation(SystemState *sys)
   }
 
   // 3. Schedule a new process if CPU is idle (or became idle)
+  HOST_PHASE(sys, SIM_PHASE_DISPATCH);
   if (needToSchedule && sys->runningProcessID < 0)
   {
     int nextPid = scheduleNextProcess(sys);
@@ -1412,6 +3594,18 @@ void stepSimulation(SystemState *sys)
       if (newlyScheduledPCB)
       { // Should always be found
         newlyScheduledPCB->state = RUNNING;
+        if (newlyScheduledPCB->firstRunTime < 0)
+        {
+          newlyScheduledPCB->firstRunTime = sys->clockCycle;
+          latencyRecord(&sys->responseHistogram, sys->clockCycle - newlyScheduledPCB->arrivalTime);
+        }
+        newlyScheduledPCB->waitingTime += sys->clockCycle - newlyScheduledPCB->readySince;
+        if (sys->lastDispatchedPid != -1 && sys->lastDispatchedPid != nextPid)
+        {
+          sys->contextSwitches++;
+          newlyScheduledPCB->contextSwitches++;
+        }
+        sys->lastDispatchedPid = nextPid;
 
         // Assign quantum based on scheduler type
         if (sys->schedulerType == SIM_SCHED_RR)
@@ -1424,31 +3618,32 @@ void stepSimulation(SystemState *sys)
           newlyScheduledPCB->quantumRemaining = sys->mlfqQuantum[newlyScheduledPCB->mlfqLevel];
           // Priority is already set by addToMLFQ
         }
-        sim_log(sys, "Scheduler: Dispatching P%d (Level: %d, Quantum: %d)",
-                newlyScheduledPCB->programNumber, newlyScheduledPCB->mlfqLevel, newlyScheduledPCB->quantumRemaining);
+        sim_event(sys, SIM_EV_DISPATCH, nextPid, newlyScheduledPCB->programNumber, newlyScheduledPCB->mlfqLevel,
+                  newlyScheduledPCB->quantumRemaining, 0, NULL);
         notify_state_update(sys); // State changed
       }
       else
       {
-        sim_log(sys, "Error: Scheduled PID %d not found!", nextPid);
+        sim_log(sys, SIM_LOG_SCHED, SIM_LOG_ERROR, "Error: Scheduled PID %d not found!", nextPid);
         sys->runningProcessID = -1; // Go back to idle
       }
     }
     else
     {
       // No process ready to run
-      sim_log(sys, "Scheduler: CPU Idle - No ready processes.");
+      sim_event(sys, SIM_EV_IDLE, -1, 0, 0, 0, 0, NULL);
       sys->runningProcessID = -1; // Ensure it remains -1
       notify_state_update(sys);   // State potentially changed if arrivals happened but no scheduling
     }
   }
 
   // 4. Execute one instruction for the running process
+  HOST_PHASE(sys, SIM_PHASE_INTERPRET);
   if (sys->runningProcessID >= 0)
   {
     PCB *currentPCB = findPCB(sys, sys->runningProcessID);
-    if (currentPCB && currentPCB->state == RUNNING && !sys->needsInput)
-    { // Ensure it's still running and not waiting for input
+    if (currentPCB && currentPCB->state == RUNNING)
+    { // Ensure it's still running
       // Decrement quantum *before* executing instruction for RR/MLFQ
       if (sys->schedulerType == SIM_SCHED_RR || sys->schedulerType == SIM_SCHED_MLFQ)
       {
@@ -1456,12 +3651,27 @@ void stepSimulation(SystemState *sys)
         // Log remaining quantum? Maybe too verbose.
       }
 
-      interpretInstruction(sys, sys->runningProcessID);
+      currentPCB->cpuCycles++;
+      LineProfile *lp = lineProfileAt(sys, currentPCB);
+      if (lp)
+        lp->executed++;
+      if (currentPCB->kind == PROCESS_BURST)
+      {
+        HOST_TIMER_BEGIN(burstStart);
+        executeBurstCycle(sys, sys->runningProcessID);
+        HOST_TIMER_END(sys->hostProfile.opcode[SIM_OP_BURST], burstStart);
+      }
+      else
+        interpretInstruction(sys, sys->runningProcessID);
 
       // Post-instruction checks: Did it terminate or block?
       if (currentPCB->state == TERMINATED)
       {
-        sim_log(sys, "P%d terminated during execution.", currentPCB->programNumber);
+        sim_event(sys, SIM_EV_TERMINATED, sys->runningProcessID, currentPCB->programNumber, 0, 0, 0, NULL);
+        currentPCB->completionTime = sys->clockCycle + 1; // Counts the cycle just executed
+        latencyRecord(&sys->waitingHistogram, currentPCB->waitingTime);
+        releaseHeldLocks(sys, sys->runningProcessID);
+        fsFlushOnExit(sys);
         // Check completion status after termination
         isSimulationComplete(sys);  // Update the flag
         sys->runningProcessID = -1; // CPU becomes idle
@@ -1476,38 +3686,52 @@ void stepSimulation(SystemState *sys)
     }
   }
 
+  HOST_PHASE(sys, -1); // Remaining bookkeeping shows up as step time outside the phases
+
+  // Blocked-queue lengths, sampled once per cycle for the contention report
+  for (int r = 0; r < NUM_RESOURCES; r++)
+  {
+    LockStats *st = &sys->mutexes[r].stats;
+    st->queueSum += sys->mutexes[r].size;
+    if (sys->mutexes[r].size > st->queueMax)
+      st->queueMax = sys->mutexes[r].size;
+  }
+
   // 5. Increment clock cycle
   sys->clockCycle++;
 
   // 6. Final check for overall simulation completion
   if (isSimulationComplete(sys))
   {
-    sim_log(sys, "Simulation Complete at Clock Cycle %d.", sys->clockCycle);
+    sim_event(sys, SIM_EV_COMPLETE, -1, 0, 0, 0, 0, NULL);
+    fsFlush(sys);
+    if (sys->fs.writeBack)
+      fsExport(sys);
+    logMetricsSummary(sys);
     notify_state_update(sys); // Notify GUI of final state
   }
+  HOST_TIMER_END(sys->hostProfile.step, stepStart);
 
   // Safety break (optional, remove if confident)
   // if (sys->clockCycle > 1000) {
-  //     sim_log(sys, "Safety break triggered at cycle 1000.");
+  //     sim_log(sys, SIM_LOG_SCHED, SIM_LOG_DEBUG, "Safety break triggered at cycle 1000.");
   //     sys->simulationComplete = true;
   //     notify_state_update(sys);
   //     return;
   // }
 }
 
+// Extracts N from ".../Program_N.txt"; other file names get program number 0
 static int getProgramNumberFromFilename(const char *filename)
 {
-  if (strstr(filename, "Program_1.txt"))
-  {
-    return 1;
-  }
-  else if (strstr(filename, "Program_2.txt"))
-  {
-    return 2;
-  }
-  else if (strstr(filename, "Program_3.txt"))
-  {
-    return 3;
+  const char *base = strrchr(filename, '/');
+  base = base ? base + 1 : filename;
+  int number = 0;
+  int consumed = 0;
+  if (sscanf(base, "Program_%d.txt%n", &number, &consumed) == 1 && consumed > 0 && base[consumed] == '\0' &&
+      number > 0)
+  {
+    return number;
   }
   return 0;
 }
\ No newline at end of file
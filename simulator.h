@@ -1,21 +1,64 @@
 #ifndef SIMULATOR_H
 #define SIMULATOR_H
 
+// Public interface of the simulator engine (libminisim). Programs embedding the
+// engine should include only this header; everything else in simulator.c is internal.
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <errno.h>
 
+// Capacity limits. The table and queue sizes can be raised for large runs by building
+// everything with e.g. make SIM_LIMITS="-DMEMORY_SIZE=4096 -DMAX_PROCESSES=256 -DMAX_QUEUE_SIZE=256"
+#ifndef MEMORY_SIZE
 #define MEMORY_SIZE 60
+#endif
 #define MAX_PROGRAM_LINES 50
 #define MAX_LINE_LENGTH 100
 #define NUM_VARIABLES 3
 #define PCB_SIZE 5 // for storing PCB fields in memory (optional)
+#ifndef MAX_PROCESSES
 #define MAX_PROCESSES 10
+#endif
+#ifndef MAX_QUEUE_SIZE
 #define MAX_QUEUE_SIZE 10
+#endif
 #define MLFQ_LEVELS 4
+#ifndef MAX_BURSTS
+#define MAX_BURSTS 16 // Phases per burst-model process
+#endif
 #define NUM_RESOURCES 3 // file, userInput, userOutput
+#ifndef FS_BLOCKS
+#define FS_BLOCKS 1024 // Simulated filesystem block store (FS_BLOCK_SIZE bytes each)
+#endif
+#ifndef FS_INODES
+#define FS_INODES 1024 // Files and directories; one generated workload writes a file per program
+#endif
+#define FS_BLOCK_SIZE 256
+#define FS_DIRECT_BLOCKS 8
+#define FS_INDIRECT_BLOCKS (FS_BLOCK_SIZE / (int)sizeof(short)) // Block numbers in an indirect block
+#define FS_MAX_FILE_BLOCKS (FS_DIRECT_BLOCKS + FS_INDIRECT_BLOCKS)
+#define FS_MAX_FILE_SIZE (FS_MAX_FILE_BLOCKS * FS_BLOCK_SIZE) // Files and directories alike
+#define FS_GROUPS 16 // Inode i's blocks are allocated from group i % FS_GROUPS of the store on
+#define FS_NAME_LENGTH 30  // Path component, including the terminator
+#define FS_CACHE_MAX 64    // Buffer cache capacity limit (see setFsCache)
+#define FS_CACHE_DEFAULT 16
+#define FS_IO_LOG_SIZE 512 // Store blocks one instruction's traffic is itemized for (see SimFs.ioLog)
+
+// Library version; bump MAJOR when this header changes incompatibly, which includes any change to the
+// layout of a struct it exposes (SystemState, PCB, ...). 2: process traces, bursts, events, metrics,
+// profiling, scripted input, filesystem, buffer cache and disk. 3: SimEvent.d. 4: InputScript cursors.
+// 5: TraceWriter tracks.
+#define MINISIM_VERSION_MAJOR 5
+#define MINISIM_VERSION_MINOR 0
+#define MINISIM_VERSION_PATCH 0
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
 
 // Forward declaration for GUI interaction callbacks
 typedef struct GuiCallbacks GuiCallbacks;
@@ -46,6 +89,21 @@ typedef enum
     RESOURCE_USER_OUTPUT
 } ResourceType;
 
+// How a process's work is described
+typedef enum
+{
+    PROCESS_PROGRAM, // Instructions loaded into memory and interpreted
+    PROCESS_BURST    // Only phase durations; no memory words at all
+} ProcessKind;
+
+// One phase of a burst-model process: `cycles` of CPU work, holding `resource`
+// for the whole phase unless it is -1 (plain CPU burst)
+typedef struct
+{
+    int cycles;
+    ResourceType resource;
+} BurstPhase;
+
 // A memory word can hold a name and a value
 typedef struct
 {
@@ -68,8 +126,79 @@ typedef struct
     ResourceType blockedOnResource;
     int quantumRemaining;
     int mlfqLevel;
+    int firstRunTime;   // Cycle of first dispatch, -1 until scheduled
+    int completionTime; // Cycle after the last instruction, -1 until terminated
+    int cpuCycles;      // Cycles spent executing instructions
+    int waitingTime;    // Cycles spent in a ready queue, counted from arrival even if a trace admitted it late
+    int readySince;     // Cycle the process last entered a ready queue
+    int blockedSince;   // Cycle the process last blocked on a resource or for input
+    int blockedCycles[NUM_RESOURCES]; // Cycles spent blocked on each resource; input waits count as userInput
+    int contextSwitches; // Dispatches that switched the CPU over from another process
+    int preemptions;     // Quantum expiries that took the CPU away
+    bool lockWaiting;    // Blocked on a lock and not yet acquired it since
+    int lockWaitSince;   // Cycle of the first request while lockWaiting
+    bool inputWaiting;   // BLOCKED on the input device until provideInput answers it
+    bool diskWaiting;    // BLOCKED until the disk completes this process's requests
+    int diskPending;     // Its requests not completed yet
+    int diskCycles;      // Cycles spent blocked on the disk
+
+    // PROCESS_BURST only: programCounter indexes bursts[]
+    ProcessKind kind;
+    BurstPhase bursts[MAX_BURSTS];
+    int burstCount;
+    int burstRemaining; // Cycles left in the current phase
+    bool burstHolding;  // The current phase's resource has been acquired
 } PCB;
 
+// Log-linear histogram of non-negative cycle counts: exact below 2^LATENCY_SUB_BITS, then
+// 2^LATENCY_SUB_BITS buckets per power of two (values within 1/16 of the truth). Recording is
+// O(1); histograms of separate runs can be merged with latencyMerge.
+#define LATENCY_SUB_BITS 4
+#define LATENCY_SUB_COUNT (1 << LATENCY_SUB_BITS)
+#define LATENCY_BUCKETS ((31 - LATENCY_SUB_BITS + 1) * LATENCY_SUB_COUNT)
+typedef struct
+{
+    long counts[LATENCY_BUCKETS];
+    long count;
+    long sum;
+    int max;
+} LatencyHistogram;
+
+// Lock contention statistics of one resource, in clock cycles
+typedef struct
+{
+    long acquisitions;
+    long contended; // Acquisitions that had to wait first
+    long holdTotal;
+    int holdMax;
+    int heldSince; // Cycle of the current acquisition
+    LatencyHistogram wait; // Wait before each acquisition (0 if uncontended)
+    long queueSum;  // Blocked-queue length summed over cycles; divide by clockCycle for the mean
+    int queueMax;
+} LockStats;
+
+// Program line where processes blocked on a lock, counted for the contention report
+#define MAX_BLOCK_SITES 64
+typedef struct
+{
+    int programNumber;
+    int line; // 0-based PC (burst phase index for burst processes)
+    ResourceType resource;
+    long count;
+} BlockSite;
+
+// Hot-spot profile of the simulated programs: what each program line cost
+#define MAX_LINE_PROFILES 256
+typedef struct
+{
+    int programNumber;
+    int line;         // 0-based PC (burst phase index for burst processes)
+    long executed;    // CPU cycles spent executing the line
+    long blocked;     // Cycles blocked on a lock at the line, added when the wait ends
+    long inputStalls; // Times the line stopped to wait for user input
+    long diskWait;    // Cycles blocked on the disk at the line
+} LineProfile;
+
 // Mutex with a FIFO + priority‐based blocked queue
 typedef struct
 {
@@ -77,8 +206,341 @@ typedef struct
     int lockingProcessID;
     int blockedQueue[MAX_QUEUE_SIZE];
     int head, tail, size;
+    LockStats stats;
 } Mutex;
 
+// Streaming workload trace: lines "<arrival> <program path>" or "<arrival> burst <phases>"
+// (phases are "cpu N" or "<resource> N" pairs), sorted by arrival. Entries are read one
+// at a time and only loaded when their arrival cycle comes.
+typedef struct
+{
+    FILE *file;
+    char dir[256];      // Directory of the trace file, prefixed to relative program paths
+    bool pending;       // `program` has been read but not admitted yet
+    bool deferLogged;   // The pending entry's deferral has been logged
+    int arrivalTime;
+    char program[256]; // Program path, or "burst ..." phase list
+    int line;
+    int admitted, skipped; // Entries loaded / dropped because they could not be loaded
+} WorkloadTrace;
+
+// Simulated filesystem used by readFile/writeFile: inodes over an in-memory block store.
+// Inode 0 is the root directory; a directory's blocks hold FsDirEntry records. Absolute paths
+// live under the root's "/" entry and ".." is kept as a literal name, so every simulated path
+// maps back to the host path it was imported from.
+typedef struct
+{
+    char name[FS_NAME_LENGTH];
+    short inode;
+} FsDirEntry;
+
+typedef struct
+{
+    bool used;
+    bool isDir;
+    bool dirty; // File changed since it was imported or exported
+    int size;   // Bytes; for directories, entries * sizeof(FsDirEntry)
+    short blocks[FS_DIRECT_BLOCKS];
+    short indirect; // Block holding the block numbers past FS_DIRECT_BLOCKS; valid once that large
+} FsInode;
+
+// Write-back buffer cache between the filesystem and its block store
+typedef enum
+{
+    FS_CACHE_LRU,
+    FS_CACHE_CLOCK
+} FsCachePolicy;
+
+typedef struct
+{
+    bool valid;
+    bool dirty;      // Newer than the store
+    bool referenced; // CLOCK second-chance bit
+    short block;
+    unsigned long lastUse; // LRU stamp
+    unsigned char data[FS_BLOCK_SIZE];
+} FsBuffer;
+
+typedef struct
+{
+    long reads, writes; // Block accesses by file operations
+    long hits, misses;
+    long diskReads, diskWrites; // Blocks moved between the cache and the store
+    long coalesced;             // Writes to an already dirty block, absorbed without a disk write
+    long evictions;
+    long flushes;
+} FsCacheStats;
+
+typedef struct
+{
+    FsInode inodes[FS_INODES];
+    unsigned char store[FS_BLOCKS][FS_BLOCK_SIZE]; // The "disk"
+    bool blockUsed[FS_BLOCKS];
+    int freeBlocks;
+    char hostDir[256]; // See setFsHostDir; empty if none
+    bool writeBack;
+
+    FsBuffer buffers[FS_CACHE_MAX];
+    unsigned char bufferOf[FS_BLOCKS]; // Buffer index + 1 caching each block, 0 if none
+    int cacheSize;                     // Buffers in use; 0 reads and writes the store directly
+    FsCachePolicy cachePolicy;
+    bool flushOnExit; // Flush when any process terminates, not only at the end
+    int clockHand;
+    unsigned long cacheTick;
+    FsCacheStats cacheStats;
+    // Store blocks read or written back since interpretInstruction cleared ioLogCount, in order;
+    // the count keeps going past FS_IO_LOG_SIZE
+    short ioLog[FS_IO_LOG_SIZE];
+    int ioLogCount;
+} SimFs;
+
+// Disk behind the block store (see setDiskModel). A file instruction that moves blocks
+// to or from the store blocks its process until the disk has served all of them: one request
+// per run of consecutive blocks on the same track.
+#define DISK_BLOCKS_PER_TRACK 4
+#define DISK_QUEUE_SIZE 1024 // Further blocks join their process's last queued request
+#define DISK_TRACKS (FS_BLOCKS / DISK_BLOCKS_PER_TRACK)
+
+// Order in which queued requests are served (see setDiskPolicy)
+typedef enum
+{
+    DISK_FCFS,  // Arrival order
+    DISK_SSTF,  // Shortest seek from the head; ties in arrival order
+    DISK_SCAN,  // Elevator: sweeps to the edge of the disk, then reverses
+    DISK_CSCAN, // Sweeps upward to the edge, returns to track 0 and sweeps again
+    DISK_CLOOK  // Sweeps upward to the last request, then jumps to the lowest one
+} DiskPolicy;
+
+typedef struct
+{
+    int pid;
+    int track;
+    int blocks;
+    int issued; // Clock cycle
+} DiskRequest;
+
+typedef struct
+{
+    int seekCycles;     // Per track the head crosses
+    int transferCycles; // Per block; 0 (the default) makes the disk instant
+    DiskPolicy policy;
+    int direction; // SCAN sweep: 1 toward higher tracks, -1 back
+    DiskRequest queue[DISK_QUEUE_SIZE + MAX_PROCESSES]; // In arrival order; each process is sure of one
+    int queued;
+    bool busy;
+    DiskRequest current;
+    int remaining; // Cycles left on current
+    int head;      // Track under the head
+
+    long requests, blocks;
+    long seekTracks;  // Total head movement, including sweeps to the edge and return jumps
+    long busyCycles;
+    LatencyHistogram latency; // Issue to completion, per request
+} SimDisk;
+
+// Accumulated metrics of terminated processes whose table slots were recycled
+typedef struct
+{
+    int count;
+    long turnaround, response, waiting, cpuCycles;
+    long blocked, contextSwitches, preemptions;
+} ProcessTotals;
+
+// Scheduling metrics of one process, in clock cycles (see getProcessMetrics).
+// Counts include the current state's time so far; times that are not known yet are -1.
+typedef struct
+{
+    int programNumber;
+    ProcessState state;
+    int arrivalTime;
+    int firstRunTime;   // -1 until dispatched
+    int completionTime; // -1 until terminated
+    int responseTime;   // firstRunTime - arrivalTime
+    int turnaroundTime; // completionTime - arrivalTime
+    int waitingTime;    // In ready queues, or held back from a trace since arrival
+    int cpuCycles;
+    int blockedCycles[NUM_RESOURCES];
+    int diskCycles;   // Waiting for the disk
+    int blockedTotal; // Including diskCycles
+    int contextSwitches;
+    int preemptions;
+} ProcessMetrics;
+
+// Log categories and levels. Each category has its own level (setLogLevel); a message is
+// emitted only if its level is at or below it. Disabled messages are never formatted.
+typedef enum
+{
+    SIM_LOG_SCHED,  // Arrivals, dispatch, quanta, clock cycles
+    SIM_LOG_INTERP, // Instruction execution and program errors
+    SIM_LOG_MEMORY, // Loading, allocation and variables
+    SIM_LOG_SYNC,   // Semaphores and blocking
+    SIM_LOG_IO,     // Input, output and files
+    SIM_LOG_CATEGORY_COUNT,
+    SIM_LOG_ALL = -1 // setLogLevel: every category
+} SimLogCategory;
+
+typedef enum
+{
+    SIM_LOG_OFF,
+    SIM_LOG_ERROR,
+    SIM_LOG_WARN,
+    SIM_LOG_INFO,
+    SIM_LOG_DEBUG // Per-cycle and per-instruction detail; the default
+} SimLogLevel;
+
+// Engine event kinds. Frequent log messages are recorded as typed SimEvent records and
+// only turned into text when a viewer asks (formatSimEvent); "P%d" arguments are program numbers.
+typedef enum
+{
+    SIM_EV_TEXT,         // Preformatted message (errors, warnings, loading)
+    SIM_EV_CYCLE,        // Start of a clock cycle
+    SIM_EV_ARRIVAL,      // a = program
+    SIM_EV_DISPATCH,     // a = program, b = MLFQ level, c = quantum
+    SIM_EV_IDLE,         // No ready process
+    SIM_EV_RR_EXPIRED,   // a = program
+    SIM_EV_MLFQ_EXPIRED, // a = program, b = level
+    SIM_EV_DEMOTED,      // a = program, b = new level
+    SIM_EV_EXECUTE,      // a = program, b = PC, text = instruction
+    SIM_EV_PROGRAM_END,  // a = program, b = PC, c = instruction count
+    SIM_EV_TERMINATED,   // a = program
+    SIM_EV_LOCK_WAIT,    // a = program, b = resource
+    SIM_EV_ACQUIRED,     // a = program, b = resource
+    SIM_EV_RELEASED,     // a = program, b = resource
+    SIM_EV_BLOCKED,      // a = program, b = resource
+    SIM_EV_UNBLOCKED,    // a = program, b = resource
+    SIM_EV_BURST,        // a = program, b = phase (1-based), c = phases, d = cycles left
+    SIM_EV_BURST_END,    // a = program
+    SIM_EV_COMPLETE,     // All processes terminated
+    SIM_EV_LOADED,       // a = program, b = arrival, text = the full message (loading is rare)
+    SIM_EV_INPUT_WAIT,   // a = program, text = variable
+    SIM_EV_INPUT_DONE,   // a = program, b = 1 if that was the program's last instruction
+    SIM_EV_DISK_WAIT,    // a = program, b = track of the first block, c = blocks
+    SIM_EV_DISK_DONE,    // a = program, b = 1 if the program finished, c = latency
+    SIM_EV_KIND_COUNT
+} SimEventKind;
+
+typedef struct
+{
+    int cycle;           // Clock cycle when recorded
+    unsigned short kind; // SimEventKind
+    short pid;           // Process table slot, -1 if none
+    int a, b, c, d;      // Kind-specific arguments
+    int text;            // Offset of a string in EventLog.text, -1 if none
+} SimEvent;
+
+// Append-only event buffer owned by the embedder and attached with setEventLog.
+// It grows as needed; eventLogClear empties it once a viewer has consumed the records.
+typedef struct
+{
+    SimEvent *events;
+    size_t count, capacity;
+    char *text; // NUL-terminated strings referenced by SimEvent.text
+    size_t textUsed, textCapacity;
+    unsigned long dropped; // Events lost because the buffer could not grow
+} EventLog;
+
+// Pre-recorded answers for 'assign x input', owned by the embedder and attached with setInputScript.
+// A request takes the first unused entry matching its program number and variable, so the entries
+// for one program form that program's queue. A script is consumed by one run at a time.
+typedef struct
+{
+    int program;   // -1 matches any program
+    char var[50];  // "*" matches any variable
+    char value[50];
+    bool used;
+} InputScriptEntry;
+
+// Where the next lookup for one (program, variable) request starts: every earlier entry it
+// matches is used, so each request key scans the script once per run
+typedef struct
+{
+    bool taken; // Slot of the open-addressing table in use
+    int program;
+    char var[50];
+    size_t next;
+} InputScriptCursor;
+
+typedef struct
+{
+    InputScriptEntry *entries;
+    size_t count, capacity;
+    InputScriptCursor *cursors; // Hash table, power-of-two size; cleared by inputScriptRewind
+    size_t cursorCount, cursorCapacity;
+} InputScript;
+
+// Process table slot as last seen by a TraceWriter
+typedef struct
+{
+    int program;     // Program number, shown as the track name
+    int track;       // Track (tid) and lock-wait id: numbered per load, as program numbers repeat
+    int state;       // ProcessState, -1 if the slot has not been seen
+    int resource;    // While BLOCKED: the resource waited for
+    int since;       // Cycle the current state began
+} TraceProcess;
+
+// Writes engine events as a Chrome/Perfetto JSON trace, one microsecond per simulated cycle:
+// a track per process with NEW/READY/RUNNING/BLOCKED slices and quantum-expiry markers, and
+// a track per resource with lock holds, waits and blocked-queue length. Feed it every EventLog batch in order; it
+// needs the sched, interp, memory and sync categories at SIM_LOG_INFO or more.
+typedef struct
+{
+    FILE *out;
+    bool first; // Nothing written after the header yet
+    TraceProcess proc[MAX_PROCESSES];
+    int holder[NUM_RESOURCES]; // Program number holding each resource, -1 if free
+    int holdSince[NUM_RESOURCES];
+    int queued[NUM_RESOURCES]; // Blocked-queue length, drawn as a counter track
+    int tracks;                // Process tracks named so far
+} TraceWriter;
+
+// Host wall-clock profile of the engine, filled only when built with -DMINISIM_HOST_PROFILE
+// (make HOST_PROFILE=1); otherwise the timing code is compiled out and this stays zero.
+typedef enum
+{
+    SIM_PHASE_ARRIVALS,
+    SIM_PHASE_QUANTUM,   // Quantum expiry checks
+    SIM_PHASE_DISPATCH,  // Choosing and dispatching the next process
+    SIM_PHASE_INTERPRET, // Executing one instruction or burst cycle
+    SIM_PHASE_CALLBACKS, // Log formatting/recording and every GuiCallbacks call, wherever made
+    SIM_PHASE_COUNT
+} SimPhase;
+
+typedef enum
+{
+    SIM_OP_NOP,
+    SIM_OP_PRINT,
+    SIM_OP_ASSIGN,
+    SIM_OP_WRITE_FILE,
+    SIM_OP_READ_FILE,
+    SIM_OP_PRINT_FROM_TO,
+    SIM_OP_SEM_WAIT,
+    SIM_OP_SEM_SIGNAL,
+    SIM_OP_UNKNOWN,
+    SIM_OP_BURST, // One cycle of a burst-model process
+    SIM_OP_COUNT
+} SimOpcode;
+
+typedef struct
+{
+    unsigned long long ns;
+    unsigned long count;
+} HostTimer;
+
+typedef struct
+{
+    HostTimer step;                   // Whole stepSimulation calls
+    HostTimer phase[SIM_PHASE_COUNT]; // Exclusive: time in callbacks is not charged to the phase making them
+    HostTimer opcode[SIM_OP_COUNT];   // Inclusive of the callbacks an instruction triggers
+    int current;                      // SimPhase being timed, -1 outside stepSimulation
+    unsigned long long mark;          // When `current` began
+} HostProfile;
+
+typedef struct
+{
+    int pid;
+    char varName[50];
+} InputRequest;
+
 // Overall system state
 typedef struct SystemState SystemState; // Forward declaration
 struct SystemState
@@ -101,12 +563,21 @@ struct SystemState
 
     int runningProcessID;
     int clockCycle;
+    unsigned long instructionsExecuted; // Instructions interpreted so far (all processes)
+    int contextSwitches;                // Dispatches of a process other than the previous one
+    int lastDispatchedPid;              // -1 before the first dispatch, -2 once its slot was recycled
 
     SchedulerType schedulerType;
     int rrQuantum;
+    int mlfqLevels; // Active MLFQ levels (1..MLFQ_LEVELS)
     int mlfqQuantum[MLFQ_LEVELS];
 
-    // Flag to indicate if simulation requires user input
+    // Pending 'assign x input' requests, oldest first. Each requester is BLOCKED on the input
+    // device while other processes keep running; provideInput answers the oldest.
+    InputRequest inputRequests[MAX_PROCESSES];
+    int inputRequestHead;
+    int inputRequestCount;
+    // The oldest pending request, if any (kept in step with inputRequests)
     bool needsInput;
     char inputVarName[50]; // Variable name needing input
     int inputPid;          // Process needing input
@@ -114,14 +585,39 @@ struct SystemState
     // GUI Interaction
     GuiCallbacks *callbacks; // Pointer to GUI callback functions
     void *gui_data;          // Pointer to GUI specific data
+    EventLog *eventLog;      // Typed event sink, NULL if none (see setEventLog)
+    InputScript *inputScript; // Answers input requests before request_input, NULL if none
+    unsigned char logLevel[SIM_LOG_CATEGORY_COUNT]; // SimLogLevel per category
 
     // Flag indicating if the simulation has completed
     bool simulationComplete;
 
     bool wasUnblockedThisCycle[MAX_PROCESSES]; // Track processes unblocked this cycle
+
+    WorkloadTrace trace;   // See openWorkloadTrace
+    SimFs fs;              // Files of readFile/writeFile
+    SimDisk disk;          // Timing of fs block-store traffic
+    ProcessTotals retired; // Processes no longer in processTable
+    LatencyHistogram responseHistogram; // Recorded at each first dispatch
+    LatencyHistogram waitingHistogram;  // Total ready-queue time, recorded at termination
+    HostProfile hostProfile;            // See MINISIM_HOST_PROFILE
+
+    // Lock contention report: where processes blocked (first MAX_BLOCK_SITES distinct sites)
+    BlockSite blockSites[MAX_BLOCK_SITES];
+    int blockSiteCount;
+    long blockSitesDropped; // Blocks at sites that did not fit
+
+    // Program line profile (first MAX_LINE_PROFILES distinct lines), hashed on program and line
+    LineProfile lineProfiles[MAX_LINE_PROFILES];
+    unsigned short lineProfileSlots[2 * MAX_LINE_PROFILES]; // Index + 1 into lineProfiles, 0 if free
+    int lineProfileCount;
+    long lineProfileDropped; // Cycles and events at lines that did not fit
 };
 
 // Structure to hold function pointers for GUI interaction
+// Any callback may be NULL. If no GuiCallbacks table is registered at all, logs and
+// process output fall back to stdout; a registered table with NULL entries discards them.
+// log_message formats every event as it happens; an attached EventLog defers that.
 struct GuiCallbacks
 {
     // Called when the simulator needs to log a message
@@ -138,14 +634,87 @@ struct GuiCallbacks
 };
 
 // Function prototypes
+const char *minisimVersion(void); // "MAJOR.MINOR.PATCH" of the linked library
 void initializeSystem(SystemState *sys, SchedulerType type, int rrQuantumVal, GuiCallbacks *callbacks, void *gui_data);
 bool loadProgram(SystemState *sys, const char *filename);
+bool loadProgramAt(SystemState *sys, const char *filename, int arrivalTime); // Arrives at the given cycle
+// Adds a burst-model process (occupies a table slot but no memory)
+bool loadBurstProcessAt(SystemState *sys, const BurstPhase *phases, int count, int arrivalTime, int programNumber);
+// Streams processes from a trace: each entry is loaded when its arrival cycle comes, reusing
+// the slots and memory of terminated processes (their metrics move to sys->retired).
+// Close the trace before re-initializing the system.
+bool openWorkloadTrace(SystemState *sys, const char *path);
+void closeWorkloadTrace(SystemState *sys);
+void setMLFQConfig(SystemState *sys, int levels, const int *quanta);         // Call before stepping
+// Simulated filesystem. Paths are '/'-separated and relative to its root; writing a file creates
+// missing parent directories. With a host directory set, a file not yet in memory is imported
+// from it on first read, and with writeBack the files changed since are exported there when the
+// simulation completes (fsExport does it on demand). initializeSystem leaves no host directory.
+void setFsHostDir(SystemState *sys, const char *dir, bool writeBack); // NULL: memory only
+bool fsWriteFile(SystemState *sys, const char *path, const char *data, size_t len);
+int fsReadFile(SystemState *sys, const char *path, char *buf, size_t size); // Length (may exceed size-1), or -1
+int fsExport(SystemState *sys); // Files written to the host directory, or -1 on error
+// Buffer cache: initializeSystem sets FS_CACHE_DEFAULT buffers, LRU, flushing only when the
+// simulation completes. buffers is clamped to [0, FS_CACHE_MAX]; call before stepping.
+void setFsCache(SystemState *sys, int buffers, FsCachePolicy policy, bool flushOnExit);
+void fsFlush(SystemState *sys); // Writes every dirty buffer back to the store
+// Disk timing: a request costs seekCycles per track crossed plus transferCycles per block.
+// Both 0 (the default) completes file instructions without blocking. Call before stepping.
+void setDiskModel(SystemState *sys, int seekCycles, int transferCycles);
+void setDiskPolicy(SystemState *sys, DiskPolicy policy); // Default DISK_FCFS
 void stepSimulation(SystemState *sys); // Executes one cycle or one event
 bool isSimulationComplete(SystemState *sys);
 PCB *findPCB(SystemState *sys, int pid);
 int findInstructionCount(SystemState *sys, int pid);
 char *getVariable(SystemState *sys, int pid, const char *var);
-void provideInput(SystemState *sys, const char *input); // Call after request_input
+void provideInput(SystemState *sys, const char *input); // Answers the oldest pending request (sys->inputPid)
+// Metrics of the process in table slot pid; false if there is none. A summary of all
+// processes is also logged (SIM_LOG_SCHED, info) when the simulation completes.
+bool getProcessMetrics(const SystemState *sys, int pid, ProcessMetrics *out);
+// Latency histograms
+void latencyRecord(LatencyHistogram *h, int value); // Negative values count as 0
+void latencyMerge(LatencyHistogram *into, const LatencyHistogram *from);
+// Value at percentile p (0-100], e.g. 99.9: the upper bound of the bucket holding that rank,
+// never above the largest recorded value. 0 for an empty histogram.
+int latencyPercentile(const LatencyHistogram *h, double p);
+// Host profile: whether this build collects it, and a text table of it (returns the length)
+bool hostProfileEnabled(void);
+int formatHostProfile(const SystemState *sys, char *buf, size_t size);
+// Copies up to max block sites, most frequent first; returns how many. Per-lock counters are in
+// sys->mutexes[r].stats.
+int getTopBlockSites(const SystemState *sys, BlockSite *out, int max);
+// Copies up to max program lines ordered like `perf report`: most executed cycles first, then
+// most blocked cycles; returns how many.
+int getLineProfile(const SystemState *sys, LineProfile *out, int max);
+
+// Log filtering; may be changed between steps. initializeSystem enables everything (SIM_LOG_DEBUG).
+void setLogLevel(SystemState *sys, SimLogCategory category, SimLogLevel level);
+// Applies a spec such as "info", "sched=debug,interp=off" or "all=warn,io=info" (applied left to right).
+// Category names: sched, interp, memory, sync, io, all; levels: off, error, warn, info, debug.
+bool parseLogLevels(SystemState *sys, const char *spec);
+
+// Event log
+void eventLogInit(EventLog *log);
+void eventLogClear(EventLog *log); // Drops all records, keeps the buffers
+void eventLogFree(EventLog *log);
+void setEventLog(SystemState *sys, EventLog *log); // NULL detaches; initializeSystem detaches too
+// Writes the text the event stands for (as log_message would receive it); returns its length
+int formatSimEvent(const EventLog *log, const SimEvent *e, char *buf, size_t size);
+
+// Input scripts. inputScriptLoad appends the lines of a file, each "<program|*> <variable|*> <value>"
+// ('#' starts a comment; the program may be written P1). Returns 0, -1 if the file cannot be
+// opened, or the number of the first line it could not take (earlier lines stay added).
+void inputScriptInit(InputScript *script);
+bool inputScriptAdd(InputScript *script, int program, const char *var, const char *value);
+int inputScriptLoad(InputScript *script, const char *path);
+void inputScriptRewind(InputScript *script); // Marks every entry unused again
+void inputScriptFree(InputScript *script);
+void setInputScript(SystemState *sys, InputScript *script); // NULL detaches; initializeSystem detaches too
+
+// Chrome/Perfetto trace export
+bool traceWriterOpen(TraceWriter *w, const char *path);
+void traceWriterAdd(TraceWriter *w, const EventLog *log); // Consumes all records; clear the log afterwards
+bool traceWriterClose(TraceWriter *w, int endCycle);      // Ends open intervals at endCycle; false on write error
 
 // These internal functions likely won't be called directly by GUI but need declaration if simulator.c is split
 // void checkArrivals(SystemState *sys);
@@ -158,4 +727,8 @@ void provideInput(SystemState *sys, const char *input); // Call after request_in
 // void blockProcess(SystemState *sys, int pid, ResourceType r);
 // void unblockProcess(SystemState *sys, ResourceType r);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // SIMULATOR_H
\ No newline at end of file
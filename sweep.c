@@ -0,0 +1,465 @@
+// sweep.c
+// Headless parameter sweep: runs every (scheduler, quantum, workload, seed) point
+// of a sweep specification as its own SystemState on a host thread pool and
+// aggregates the results into one table.
+//
+// Specification file (one directive per line, '#' starts a comment):
+//   schedulers FCFS RR MLFQ
+//   quanta 1 2 4           RR quantum, or MLFQ level-0 quantum (doubling per level)
+//   seeds 1 2 3            seed 0 keeps arrivals exactly as written
+//   jitter 2               seeded runs delay each arrival by 0..jitter cycles
+//   cycles 10000           cycle limit per run
+//   inputs 1 5             values for 'assign x input', used in order
+//   inputscript answers.txt  input script tried before inputs (see minisim -I)
+//   workload demo Program_1.txt@0 Program_2.txt@1 Program_3.txt@2
+// Relative program and input script paths are taken from the spec file's directory.
+
+#include "batch.h"
+#include <unistd.h> // For getopt
+
+#define MAX_SWEEP_VALUES 32
+#define MAX_SWEEP_WORKLOADS 32
+#define MAX_SPEC_LINE 1024
+
+typedef struct
+{
+  char name[32];
+  Workload workload;
+} NamedWorkload;
+
+typedef struct
+{
+  SchedulerType schedulers[3];
+  int schedulerCount;
+  int quanta[MAX_SWEEP_VALUES];
+  int quantumCount;
+  unsigned seeds[MAX_SWEEP_VALUES];
+  int seedCount;
+  NamedWorkload workloads[MAX_SWEEP_WORKLOADS];
+  int workloadCount;
+  char *inputs[BATCH_MAX_INPUTS];
+  int inputCount;
+  InputScript inputScript;
+  int jitter;
+  int maxCycles;
+  char dir[BATCH_PATH_LENGTH]; // Directory of the spec file, with a trailing '/'; empty for the cwd
+} SweepSpec;
+
+typedef struct
+{
+  SchedulerConfig config;
+  int workload;
+  unsigned seed;
+  RunResult result;
+} SweepPoint;
+
+typedef struct
+{
+  const SweepSpec *spec;
+  SweepPoint *points;
+} SweepContext;
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+          "Usage: %s [options] spec-file\n"
+          "  -j threads  worker threads (default: one per core)\n"
+          "  -r          print every run instead of aggregating over seeds\n"
+          "  -f format   table (default) or csv\n",
+          prog);
+}
+
+// ------------- Spec Parsing -------------
+
+static bool parseSchedulerName(const char *s, SchedulerType *out)
+{
+  if (strcmp(s, "FCFS") == 0)
+    *out = SIM_SCHED_FCFS;
+  else if (strcmp(s, "RR") == 0)
+    *out = SIM_SCHED_RR;
+  else if (strcmp(s, "MLFQ") == 0)
+    *out = SIM_SCHED_MLFQ;
+  else
+    return false;
+  return true;
+}
+
+static bool parsePositive(const char *s, int *out)
+{
+  char *endptr;
+  long v = strtol(s, &endptr, 10);
+  if (*endptr != '\0' || v < 0)
+    return false;
+  *out = (int)v;
+  return true;
+}
+
+// Resolves a path written in the spec against the spec file's directory
+static bool specPath(const SweepSpec *spec, const char *path, char *out, size_t size)
+{
+  int n = snprintf(out, size, "%s%s", path[0] == '/' ? "" : spec->dir, path);
+  return n >= 0 && (size_t)n < size;
+}
+
+static bool parseSpecLine(SweepSpec *spec, char *line, int lineNo)
+{
+  char *save = NULL;
+  char *key = strtok_r(line, " \t", &save);
+  if (!key || key[0] == '#')
+    return true; // Blank line or comment
+
+  char *tok;
+  if (strcmp(key, "schedulers") == 0)
+  {
+    while ((tok = strtok_r(NULL, " \t", &save)))
+    {
+      SchedulerType type;
+      if (!parseSchedulerName(tok, &type))
+        goto bad;
+      for (int i = 0; i < spec->schedulerCount; i++)
+      {
+        if (spec->schedulers[i] == type)
+        {
+          fprintf(stderr, "Error: line %d: scheduler '%s' listed twice\n", lineNo, tok);
+          return false;
+        }
+      }
+      if (spec->schedulerCount >= 3)
+      {
+        fprintf(stderr, "Error: line %d: at most 3 schedulers\n", lineNo);
+        return false;
+      }
+      spec->schedulers[spec->schedulerCount++] = type;
+    }
+  }
+  else if (strcmp(key, "quanta") == 0)
+  {
+    while ((tok = strtok_r(NULL, " \t", &save)))
+    {
+      if (spec->quantumCount >= MAX_SWEEP_VALUES)
+      {
+        fprintf(stderr, "Error: line %d: at most %d quanta\n", lineNo, MAX_SWEEP_VALUES);
+        return false;
+      }
+      if (!parsePositive(tok, &spec->quanta[spec->quantumCount]) || spec->quanta[spec->quantumCount] == 0)
+        goto bad;
+      spec->quantumCount++;
+    }
+  }
+  else if (strcmp(key, "seeds") == 0)
+  {
+    while ((tok = strtok_r(NULL, " \t", &save)))
+    {
+      if (spec->seedCount >= MAX_SWEEP_VALUES)
+      {
+        fprintf(stderr, "Error: line %d: at most %d seeds\n", lineNo, MAX_SWEEP_VALUES);
+        return false;
+      }
+      int seed;
+      if (!parsePositive(tok, &seed))
+        goto bad;
+      spec->seeds[spec->seedCount++] = (unsigned)seed;
+    }
+  }
+  else if (strcmp(key, "jitter") == 0 || strcmp(key, "cycles") == 0)
+  {
+    tok = strtok_r(NULL, " \t", &save);
+    if (!tok || !parsePositive(tok, key[0] == 'j' ? &spec->jitter : &spec->maxCycles))
+      goto bad;
+  }
+  else if (strcmp(key, "inputs") == 0)
+  {
+    while ((tok = strtok_r(NULL, " \t", &save)))
+    {
+      if (spec->inputCount >= BATCH_MAX_INPUTS)
+      {
+        fprintf(stderr, "Error: line %d: at most %d inputs\n", lineNo, BATCH_MAX_INPUTS);
+        return false;
+      }
+      spec->inputs[spec->inputCount++] = strdup(tok);
+    }
+  }
+  else if (strcmp(key, "inputscript") == 0)
+  {
+    tok = strtok_r(NULL, " \t", &save);
+    char path[BATCH_PATH_LENGTH];
+    if (!tok || !specPath(spec, tok, path, sizeof(path)))
+      goto bad;
+    tok = path;
+    int badLine = inputScriptLoad(&spec->inputScript, tok);
+    if (badLine != 0)
+    {
+      if (badLine < 0)
+        fprintf(stderr, "Error: line %d: cannot open input script '%s'\n", lineNo, tok);
+      else
+        fprintf(stderr, "Error: %s:%d: expected '<program|*> <variable|*> <value>'\n", tok, badLine);
+      return false;
+    }
+  }
+  else if (strcmp(key, "workload") == 0)
+  {
+    if (spec->workloadCount >= MAX_SWEEP_WORKLOADS)
+    {
+      fprintf(stderr, "Error: line %d: at most %d workloads\n", lineNo, MAX_SWEEP_WORKLOADS);
+      return false;
+    }
+    NamedWorkload *nw = &spec->workloads[spec->workloadCount];
+    memset(nw, 0, sizeof(*nw));
+    tok = strtok_r(NULL, " \t", &save);
+    if (!tok)
+      goto bad;
+    snprintf(nw->name, sizeof(nw->name), "%s", tok);
+    while ((tok = strtok_r(NULL, " \t", &save)))
+    {
+      char resolved[BATCH_PATH_LENGTH];
+      if (!specPath(spec, tok, resolved, sizeof(resolved)) || !addWorkloadProgram(&nw->workload, resolved))
+        goto bad;
+      const char *program = nw->workload.programs[nw->workload.count - 1].path;
+      FILE *f = fopen(program, "r");
+      if (!f)
+      {
+        fprintf(stderr, "Error: line %d: cannot open program '%s': %s\n", lineNo, program, strerror(errno));
+        return false;
+      }
+      fclose(f);
+    }
+    if (nw->workload.count == 0)
+      goto bad;
+    spec->workloadCount++;
+  }
+  else
+  {
+    fprintf(stderr, "Error: line %d: unknown directive '%s'\n", lineNo, key);
+    return false;
+  }
+  return true;
+
+bad:
+  fprintf(stderr, "Error: line %d: malformed '%s' directive\n", lineNo, key);
+  return false;
+}
+
+static bool loadSweepSpec(const char *path, SweepSpec *spec)
+{
+  FILE *f = fopen(path, "r");
+  if (!f)
+  {
+    fprintf(stderr, "Error opening sweep spec '%s': %s\n", path, strerror(errno));
+    return false;
+  }
+
+  memset(spec, 0, sizeof(*spec));
+  spec->maxCycles = 10000;
+  const char *slash = strrchr(path, '/');
+  if (slash && (size_t)(slash - path + 1) < sizeof(spec->dir))
+    memcpy(spec->dir, path, slash - path + 1);
+  char line[MAX_SPEC_LINE];
+  int lineNo = 0;
+  bool ok = true;
+  while (ok && fgets(line, sizeof(line), f))
+  {
+    lineNo++;
+    line[strcspn(line, "\r\n")] = 0;
+    ok = parseSpecLine(spec, line, lineNo);
+  }
+  fclose(f);
+  if (!ok)
+    return false;
+
+  // Defaults for anything the spec leaves out
+  if (spec->schedulerCount == 0)
+  {
+    spec->schedulers[spec->schedulerCount++] = SIM_SCHED_FCFS;
+    spec->schedulers[spec->schedulerCount++] = SIM_SCHED_RR;
+    spec->schedulers[spec->schedulerCount++] = SIM_SCHED_MLFQ;
+  }
+  if (spec->quantumCount == 0)
+    spec->quanta[spec->quantumCount++] = 2;
+  if (spec->seedCount == 0)
+    spec->seeds[spec->seedCount++] = 0;
+  if (spec->workloadCount == 0)
+  {
+    fprintf(stderr, "Error: sweep spec '%s' has no workloads\n", path);
+    return false;
+  }
+  for (int i = 0; i < spec->workloadCount; i++)
+  {
+    for (int k = 0; k < spec->inputCount; k++)
+    {
+      addWorkloadInput(&spec->workloads[i].workload, spec->inputs[k]);
+    }
+    spec->workloads[i].workload.inputScript = &spec->inputScript;
+  }
+  return true;
+}
+
+// ------------- Running -------------
+
+static int buildPoints(const SweepSpec *spec, SweepPoint *points)
+{
+  int n = 0;
+  for (int s = 0; s < spec->schedulerCount; s++)
+  {
+    // FCFS has no quantum, so it contributes a single configuration
+    int quanta = spec->schedulers[s] == SIM_SCHED_FCFS ? 1 : spec->quantumCount;
+    for (int q = 0; q < quanta; q++)
+    {
+      SchedulerConfig cfg;
+      defaultSchedulerConfig(&cfg, spec->schedulers[s], spec->quanta[q]);
+      if (cfg.type == SIM_SCHED_MLFQ)
+      {
+        for (int l = 0; l < MLFQ_LEVELS; l++)
+        {
+          cfg.mlfqQuantum[l] = spec->quanta[q] << l;
+        }
+      }
+      for (int w = 0; w < spec->workloadCount; w++)
+      {
+        for (int k = 0; k < spec->seedCount; k++)
+        {
+          points[n].config = cfg;
+          points[n].workload = w;
+          points[n].seed = spec->seeds[k];
+          n++;
+        }
+      }
+    }
+  }
+  return n;
+}
+
+static void sweep_job(void *ctx, int index)
+{
+  SweepContext *c = (SweepContext *)ctx;
+  SweepPoint *p = &c->points[index];
+  Workload w = c->spec->workloads[p->workload].workload;
+
+  if (p->seed != 0 && c->spec->jitter > 0)
+  {
+    uint64_t rng = p->seed;
+    for (int i = 0; i < w.count; i++)
+    {
+      w.programs[i].arrivalTime += batchRandomRange(&rng, c->spec->jitter + 1);
+    }
+  }
+  runWorkload(&w, &p->config, c->spec->maxCycles, &p->result);
+}
+
+// ------------- Reporting -------------
+
+static void printHeader(bool csv, bool raw)
+{
+  if (csv)
+    printf("scheduler,workload,%s,avg_turnaround,avg_response,p50_response,p90_response,p99_response,p999_response,"
+           "cycles,completed\n",
+           raw ? "seed" : "runs");
+  else
+    printf("%-32s %-12s %6s %14s %12s %8s %8s %8s %8s %10s %9s\n", "Scheduler", "Workload", raw ? "Seed" : "Runs",
+           "AvgTurnaround", "AvgResponse", "P50Resp", "P90Resp", "P99Resp", "P999Resp", "Cycles", "Completed");
+}
+
+// Response percentiles come from the (merged) histogram of every process in the row's runs
+static void printRow(bool csv, const char *sched, const char *workload, unsigned col, double turnaround,
+                     double response, const LatencyHistogram *responses, double cycles, int completed, int runs)
+{
+  int p50 = latencyPercentile(responses, 50), p90 = latencyPercentile(responses, 90);
+  int p99 = latencyPercentile(responses, 99), p999 = latencyPercentile(responses, 99.9);
+  if (csv)
+    printf("%s,%s,%u,%.3f,%.3f,%d,%d,%d,%d,%.1f,%d\n", sched, workload, col, turnaround, response, p50, p90, p99, p999,
+           cycles, completed);
+  else
+    printf("%-32s %-12s %6u %14.2f %12.2f %8d %8d %8d %8d %10.1f %5d/%-3d\n", sched, workload, col, turnaround,
+           response, p50, p90, p99, p999, cycles, completed, runs);
+}
+
+int main(int argc, char **argv)
+{
+  int threads = 0;
+  bool raw = false, csv = false;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "j:rf:h")) != -1)
+  {
+    switch (opt)
+    {
+    case 'j':
+      threads = atoi(optarg);
+      break;
+    case 'r':
+      raw = true;
+      break;
+    case 'f':
+      csv = strcmp(optarg, "csv") == 0;
+      break;
+    default:
+      usage(argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+  if (optind != argc - 1)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  static SweepSpec spec; // Large; keep it off the stack
+  if (!loadSweepSpec(argv[optind], &spec))
+    return 2;
+
+  int maxPoints = spec.schedulerCount * spec.quantumCount * spec.workloadCount * spec.seedCount;
+  SweepPoint *points = calloc(maxPoints, sizeof(SweepPoint));
+  if (!points)
+  {
+    fprintf(stderr, "Error: out of memory\n");
+    return 1;
+  }
+  int count = buildPoints(&spec, points);
+
+  SweepContext ctx = {&spec, points};
+  fprintf(stderr, "Running %d sweep points on %d thread(s)...\n", count, threads > 0 ? threads : hostCoreCount());
+  runParallel(count, threads, sweep_job, &ctx);
+
+  // Points for one configuration and workload are contiguous (seeds innermost)
+  printHeader(csv, raw);
+  int failed = 0;
+  for (int i = 0; i < count; i += spec.seedCount)
+  {
+    char name[64];
+    formatSchedulerConfig(&points[i].config, name, sizeof(name));
+    const char *wname = spec.workloads[points[i].workload].name;
+    double turnaround = 0, response = 0, cycles = 0;
+    int completed = 0;
+    LatencyHistogram responses = {0};
+    for (int k = 0; k < spec.seedCount; k++)
+    {
+      const SweepPoint *p = &points[i + k];
+      if (p->result.completed)
+        completed++;
+      else
+        failed++;
+      if (raw)
+      {
+        printRow(csv, name, wname, p->seed, p->result.avgTurnaround, p->result.avgResponse,
+                 &p->result.responseHistogram, p->result.cycles, p->result.completed, 1);
+        continue;
+      }
+      turnaround += p->result.avgTurnaround;
+      response += p->result.avgResponse;
+      cycles += p->result.cycles;
+      latencyMerge(&responses, &p->result.responseHistogram);
+    }
+    if (!raw)
+    {
+      int n = spec.seedCount;
+      printRow(csv, name, wname, n, turnaround / n, response / n, &responses, cycles / n, completed, n);
+    }
+  }
+
+  free(points);
+  for (int i = 0; i < spec.inputCount; i++)
+  {
+    free(spec.inputs[i]);
+  }
+  inputScriptFree(&spec.inputScript);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,9 @@
+# Example sweep: ./minisimsweep sweep_example.spec
+schedulers FCFS RR MLFQ
+quanta 1 2 4
+seeds 0 1 2 3
+jitter 2
+cycles 10000
+inputs 1 5
+workload p1p3 Program_1.txt@0 Program_3.txt@2
+workload p1x2 Program_1.txt@0 Program_1.txt@1
@@ -0,0 +1,200 @@
+// tune.c
+// Searches RR quanta and MLFQ levels/quanta for a workload, running every
+// candidate configuration as an independent simulation across host cores.
+
+#include "batch.h"
+#include <unistd.h> // For getopt
+
+typedef enum
+{
+  METRIC_TURNAROUND,
+  METRIC_P99_RESPONSE
+} TuneMetric;
+
+typedef struct
+{
+  const Workload *workload;
+  SchedulerConfig *configs;
+  RunResult *results;
+  int maxCycles;
+} TuneContext;
+
+static TuneMetric tuneMetric = METRIC_TURNAROUND; // Read by compareCandidates only
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+          "Usage: %s [options] program[@arrival]...\n"
+          "  -m metric   turnaround (default) or p99 (p99 response time)\n"
+          "  -q max      largest quantum to try (default 8)\n"
+          "  -c cycles   cycle limit per run (default 10000)\n"
+          "  -j threads  worker threads (default: one per core)\n"
+          "  -i value    value for 'assign x input' (repeatable, used in order)\n"
+          "  -n count    number of ranked configurations to print (default 5)\n",
+          prog);
+}
+
+static void tune_job(void *ctx, int index)
+{
+  TuneContext *t = (TuneContext *)ctx;
+  runWorkload(t->workload, &t->configs[index], t->maxCycles, &t->results[index]);
+}
+
+static double metricValue(const RunResult *r)
+{
+  return tuneMetric == METRIC_TURNAROUND ? r->avgTurnaround : (double)r->p99Response;
+}
+
+// Orders result indices: completed runs first, then by the chosen metric, then by total cycles
+static const RunResult *sortResults;
+static int compareCandidates(const void *a, const void *b)
+{
+  const RunResult *x = &sortResults[*(const int *)a];
+  const RunResult *y = &sortResults[*(const int *)b];
+  if (x->completed != y->completed)
+    return x->completed ? -1 : 1;
+  double mx = metricValue(x), my = metricValue(y);
+  if (mx != my)
+    return mx < my ? -1 : 1;
+  return x->cycles - y->cycles;
+}
+
+// Builds the candidate list: FCFS baseline, RR q=1..maxQuantum and geometric MLFQ quanta
+static int buildCandidates(SchedulerConfig *configs, int maxQuantum)
+{
+  int n = 0;
+  defaultSchedulerConfig(&configs[n++], SIM_SCHED_FCFS, 0);
+  for (int q = 1; q <= maxQuantum; q++)
+  {
+    defaultSchedulerConfig(&configs[n++], SIM_SCHED_RR, q);
+  }
+  for (int levels = 1; levels <= MLFQ_LEVELS; levels++)
+  {
+    for (int base = 1; base <= maxQuantum; base++)
+    {
+      // A single level has no growth to vary
+      for (int growth = 1; growth <= (levels > 1 ? 3 : 1); growth++)
+      {
+        SchedulerConfig *cfg = &configs[n++];
+        defaultSchedulerConfig(cfg, SIM_SCHED_MLFQ, 0);
+        cfg->mlfqLevels = levels;
+        int q = base;
+        for (int l = 0; l < levels; l++)
+        {
+          cfg->mlfqQuantum[l] = q;
+          q *= growth;
+        }
+      }
+    }
+  }
+  return n;
+}
+
+int main(int argc, char **argv)
+{
+  Workload workload = {0};
+  int maxQuantum = 8, maxCycles = 10000, threads = 0, top = 5;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "m:q:c:j:i:n:h")) != -1)
+  {
+    switch (opt)
+    {
+    case 'm':
+      if (strcmp(optarg, "turnaround") == 0)
+        tuneMetric = METRIC_TURNAROUND;
+      else if (strcmp(optarg, "p99") == 0)
+        tuneMetric = METRIC_P99_RESPONSE;
+      else
+      {
+        usage(argv[0]);
+        return 2;
+      }
+      break;
+    case 'q':
+      maxQuantum = atoi(optarg);
+      break;
+    case 'c':
+      maxCycles = atoi(optarg);
+      break;
+    case 'j':
+      threads = atoi(optarg);
+      break;
+    case 'i':
+      if (!addWorkloadInput(&workload, optarg))
+        return 2;
+      break;
+    case 'n':
+      top = atoi(optarg);
+      break;
+    default:
+      usage(argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+  for (int i = optind; i < argc; i++)
+  {
+    if (!addWorkloadProgram(&workload, argv[i]))
+      return 2;
+  }
+  if (workload.count == 0 || maxQuantum < 1 || maxCycles < 1)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  int maxCandidates = 1 + maxQuantum + MLFQ_LEVELS * maxQuantum * 3;
+  SchedulerConfig *configs = malloc(sizeof(SchedulerConfig) * maxCandidates);
+  RunResult *results = malloc(sizeof(RunResult) * maxCandidates);
+  int *order = malloc(sizeof(int) * maxCandidates);
+  if (!configs || !results || !order)
+  {
+    fprintf(stderr, "Error: out of memory\n");
+    return 1;
+  }
+  int count = buildCandidates(configs, maxQuantum);
+
+  TuneContext ctx = {&workload, configs, results, maxCycles};
+  int used = threads > 0 ? threads : hostCoreCount();
+  printf("Evaluating %d configurations on %d thread(s)...\n", count, used);
+  runParallel(count, threads, tune_job, &ctx);
+
+  // Every candidate loads the same programs, so a load failure shows up in the first run
+  if (results[0].failedProgram >= 0)
+  {
+    fprintf(stderr, "Error: cannot load '%s' (run minisim on it for the reason)\n",
+            workload.programs[results[0].failedProgram].path);
+    free(configs);
+    free(results);
+    free(order);
+    return 1;
+  }
+
+  for (int i = 0; i < count; i++)
+  {
+    order[i] = i;
+  }
+  sortResults = results;
+  qsort(order, count, sizeof(int), compareCandidates);
+
+  printf("%-4s %-36s %14s %12s %12s %8s\n", "Rank", "Configuration", "AvgTurnaround", "AvgResponse", "P99Response", "Cycles");
+  for (int i = 0; i < count && i < top; i++)
+  {
+    const RunResult *r = &results[order[i]];
+    char name[64];
+    formatSchedulerConfig(&configs[order[i]], name, sizeof(name));
+    printf("%-4d %-36s %14.2f %12.2f %12d %8d%s\n", i + 1, name, r->avgTurnaround, r->avgResponse,
+           r->p99Response, r->cycles, r->completed ? "" : " (incomplete)");
+  }
+
+  const RunResult *best = &results[order[0]];
+  char bestName[64];
+  formatSchedulerConfig(&configs[order[0]], bestName, sizeof(bestName));
+  printf("Best by %s: %s\n", tuneMetric == METRIC_TURNAROUND ? "average turnaround" : "p99 response time", bestName);
+  int status = best->completed ? 0 : 1;
+
+  free(configs);
+  free(results);
+  free(order);
+  return status;
+}